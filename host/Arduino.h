@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+// ========================================
+// Host Arduino Stand-in
+// ========================================
+// Just enough of the Arduino API for LVGL's tick source (lv_conf.h uses
+// millis()) in the native build. The clock is scripted: it only moves
+// when the bench advances it, so every run renders the same frames.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// C linkage: LVGL's tick code is C and calls these too
+uint32_t millis(void);
+uint32_t micros(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Move the fake clock forward
+void fakeClockAdvance(uint32_t ms);
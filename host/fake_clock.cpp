@@ -0,0 +1,15 @@
+#include "Arduino.h"
+
+static uint64_t fakeNowUs = 0;
+
+uint32_t millis() {
+    return (uint32_t)(fakeNowUs / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t)fakeNowUs;
+}
+
+void fakeClockAdvance(uint32_t ms) {
+    fakeNowUs += (uint64_t)ms * 1000;
+}
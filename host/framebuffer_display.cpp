@@ -0,0 +1,111 @@
+#include "framebuffer_display.h"
+
+#include <stdio.h>
+#include <string.h>
+#include "lvgl.h"
+#include "pin_config.h"
+
+#define FB_WIDTH  EXAMPLE_LCD_H_RES
+#define FB_HEIGHT EXAMPLE_LCD_V_RES
+
+// Standard (unswapped) RGB565, row-major
+static uint16_t framebuffer[FB_WIDTH * FB_HEIGHT];
+
+static lv_disp_draw_buf_t drawBuf;
+static lv_disp_drv_t dispDrv;
+static lv_color_t drawPixels[LVGL_DRAW_BUF_SIZE];
+#if LVGL_DOUBLE_BUFFER
+static lv_color_t drawPixels2[LVGL_DRAW_BUF_SIZE];
+#endif
+
+static FramebufferStats stats;
+
+static uint16_t toRgb565(lv_color_t c) {
+#if LV_COLOR_16_SWAP
+    // The panel wants big-endian pixels, so LVGL stores them swapped
+    return (uint16_t)((c.full >> 8) | (c.full << 8));
+#else
+    return c.full;
+#endif
+}
+
+static void flushCb(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* colorMap) {
+    for (int y = area->y1; y <= area->y2; y++) {
+        uint16_t* row = &framebuffer[y * FB_WIDTH];
+        for (int x = area->x1; x <= area->x2; x++) {
+            row[x] = toRgb565(*colorMap++);
+        }
+    }
+    stats.flushes++;
+    stats.flushedPixels += lv_area_get_size(area);
+    lv_disp_flush_ready(drv);
+}
+
+// Called once per refresh with the number of pixels redrawn
+static void monitorCb(lv_disp_drv_t* drv, uint32_t timeMs, uint32_t px) {
+    (void)drv;
+    (void)timeMs;
+    stats.refreshedPixels += px;
+}
+
+void framebufferInit() {
+#if LVGL_DOUBLE_BUFFER
+    lv_disp_draw_buf_init(&drawBuf, drawPixels, drawPixels2, LVGL_DRAW_BUF_SIZE);
+#else
+    lv_disp_draw_buf_init(&drawBuf, drawPixels, NULL, LVGL_DRAW_BUF_SIZE);
+#endif
+    lv_disp_drv_init(&dispDrv);
+    dispDrv.hor_res = FB_WIDTH;
+    dispDrv.ver_res = FB_HEIGHT;
+    dispDrv.flush_cb = flushCb;
+    dispDrv.monitor_cb = monitorCb;
+    dispDrv.draw_buf = &drawBuf;
+    lv_disp_drv_register(&dispDrv);
+}
+
+FramebufferStats framebufferTakeStats() {
+    FramebufferStats taken = stats;
+    memset(&stats, 0, sizeof(stats));
+    return taken;
+}
+
+static void toRgb888(uint16_t px, uint8_t* out) {
+    out[0] = (uint8_t)(((px >> 11) & 0x1F) * 255 / 31);
+    out[1] = (uint8_t)(((px >> 5) & 0x3F) * 255 / 63);
+    out[2] = (uint8_t)((px & 0x1F) * 255 / 31);
+}
+
+bool framebufferWritePpm(const char* path) {
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", FB_WIDTH, FB_HEIGHT);
+    uint8_t rgb[3];
+    for (int i = 0; i < FB_WIDTH * FB_HEIGHT; i++) {
+        toRgb888(framebuffer[i], rgb);
+        fwrite(rgb, 1, 3, f);
+    }
+    return fclose(f) == 0;
+}
+
+long framebufferDiffPpm(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return -1;
+    int width = 0, height = 0, maxval = 0;
+    if (fscanf(f, "P6 %d %d %d", &width, &height, &maxval) != 3 ||
+        width != FB_WIDTH || height != FB_HEIGHT || maxval != 255 || fgetc(f) == EOF) {
+        fclose(f);
+        return -1;
+    }
+    long differing = 0;
+    uint8_t expected[3], actual[3];
+    for (int i = 0; i < FB_WIDTH * FB_HEIGHT; i++) {
+        if (fread(expected, 1, 3, f) != 3) {
+            fclose(f);
+            return -1;
+        }
+        toRgb888(framebuffer[i], actual);
+        if (memcmp(expected, actual, 3) != 0) differing++;
+    }
+    fclose(f);
+    return differing;
+}
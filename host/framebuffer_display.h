@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+// ========================================
+// Framebuffer Display Driver
+// ========================================
+// An LVGL display whose flush callback copies into an in-memory RGB565
+// framebuffer the size of the panel, with the same draw buffer mode as
+// the board (pin_config.h). Counts flushes and bytes the way the i80 bus
+// would see them, and the area LVGL invalidated and redrew.
+
+struct FramebufferStats {
+    uint32_t flushes;
+    uint32_t flushedPixels;     // Sent to the "panel"
+    uint32_t refreshedPixels;   // Invalidated area LVGL redrew
+};
+
+// Register the display with LVGL; call after lv_init()
+void framebufferInit();
+
+// Counters since the previous call
+FramebufferStats framebufferTakeStats();
+
+// Write the framebuffer as a binary PPM (RGB888)
+bool framebufferWritePpm(const char* path);
+
+// Number of pixels that differ from a PPM written earlier, or -1 if it
+// can't be read or has a different size
+long framebufferDiffPpm(const char* path);
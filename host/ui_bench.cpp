@@ -0,0 +1,148 @@
+// ========================================
+// UI Render Bench (native build)
+// ========================================
+// Drives createUI()/showStatus()/updateWeatherDisplay() through a fixed
+// sequence of screens and reports, per step, the render time, label
+// changes, invalidated area and what would go over the i80 bus.
+//
+//   ui_bench [--dump DIR] [--compare DIR]
+//
+// --dump writes one PPM per step; --compare diffs each step against a
+// previous dump and exits 1 if any pixel changed.
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "lvgl.h"
+#include "Arduino.h"
+#include "pin_config.h"
+#include "weather_ui.h"
+#include "framebuffer_display.h"
+
+// The tests in test/ link the same sources and bring their own main()
+#ifndef PIO_UNIT_TESTING
+
+// Fixed wall clock, so the stale marker is reproducible
+#define BENCH_NOW 1760000000
+
+static const char* dumpDir = NULL;
+static const char* compareDir = NULL;
+static int stepNumber = 0;
+static int mismatches = 0;
+
+static void setDay(WeatherDay& day, const char* date, const char* name, const char* desc,
+                   int16_t high, int16_t low) {
+    strncpy(day.date, date, sizeof(day.date) - 1);
+    strncpy(day.day_name, name, sizeof(day.day_name) - 1);
+    strncpy(day.description, desc, sizeof(day.description) - 1);
+    day.temp_high = high;
+    day.temp_low = low;
+    day.humidity = 60;
+}
+
+static WeatherSnapshot sampleWeather() {
+    WeatherSnapshot weather;
+    memset(&weather, 0, sizeof(weather));
+    setDay(weather.forecast[0], "10-09", "Thu", "light rain", 684, 512);
+    setDay(weather.forecast[1], "10-10", "Fri", "scattered clouds", 712, 498);
+    setDay(weather.forecast[2], "10-11", "Sat", "clear sky", 745, 521);
+    weather.currentTemp = 631;
+    strncpy(weather.currentCondition, "overcast clouds", sizeof(weather.currentCondition) - 1);
+    weather.timezoneOffset = -5 * 3600;
+    weather.fetchedAt = BENCH_NOW;
+    return weather;
+}
+
+// Render what the step changed, then report and dump/compare the frame
+static void finishStep(const char* name, int changes,
+                       std::chrono::steady_clock::time_point start) {
+    lv_refr_now(NULL);
+    long us = (long)std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start).count();
+    FramebufferStats stats = framebufferTakeStats();
+    fakeClockAdvance(1000);
+
+    printf("%2d %-22s %7ld us %3d chg %6u px inv %3u flush %7u B\n", stepNumber, name, us,
+           changes, (unsigned)stats.refreshedPixels, (unsigned)stats.flushes,
+           (unsigned)(stats.flushedPixels * sizeof(uint16_t)));
+
+    char path[256];
+    if (dumpDir) {
+        snprintf(path, sizeof(path), "%s/%02d_%s.ppm", dumpDir, stepNumber, name);
+        if (!framebufferWritePpm(path)) printf("   can't write %s\n", path);
+    }
+    if (compareDir) {
+        snprintf(path, sizeof(path), "%s/%02d_%s.ppm", compareDir, stepNumber, name);
+        long differing = framebufferDiffPpm(path);
+        if (differing != 0) {
+            mismatches++;
+            if (differing < 0) {
+                printf("   no usable reference %s\n", path);
+            } else {
+                printf("   %ld px differ from %s\n", differing, path);
+            }
+        }
+    }
+    stepNumber++;
+}
+
+static void statusStep(const char* name, const char* message, bool tilesShown) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    showStatus(message, tilesShown);
+    finishStep(name, 1, start);
+}
+
+static void weatherStep(const char* name, const WeatherSnapshot& weather, time_t now) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int changes = updateWeatherDisplay(weather, now);
+    finishStep(name, changes, start);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--dump") == 0) {
+            dumpDir = argv[i + 1];
+        } else if (strcmp(argv[i], "--compare") == 0) {
+            compareDir = argv[i + 1];
+        } else {
+            fprintf(stderr, "usage: %s [--dump DIR] [--compare DIR]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    lv_init();
+    framebufferInit();
+    createUI();
+
+    printf("Draw buffer: %s, %u px\n",
+           LVGL_DOUBLE_BUFFER ? "double partial" : "single full frame",
+           (unsigned)LVGL_DRAW_BUF_SIZE);
+    finishStep("boot", 0, std::chrono::steady_clock::now());
+
+    statusStep("status_wifi", "Connecting to WiFi...", false);
+    statusStep("status_fetch", "Fetching Weather...", false);
+
+    WeatherSnapshot weather = sampleWeather();
+    weatherStep("first_forecast", weather, BENCH_NOW);
+    weatherStep("identical_refresh", weather, BENCH_NOW + 60);
+
+    weather.currentTemp = 647;
+    weather.forecast[1].temp_high = 720;
+    weatherStep("temperature_change", weather, BENCH_NOW + 120);
+
+    strncpy(weather.forecast[2].description, "thunderstorm with rain",
+            sizeof(weather.forecast[2].description) - 1);
+    weatherStep("description_change", weather, BENCH_NOW + 180);
+
+    weatherStep("stale", weather, BENCH_NOW + STALE_AFTER_SEC + 1);
+    statusStep("status_over_tiles", "Weather Fetch Failed", true);
+
+    weather.fetchedAt = BENCH_NOW + STALE_AFTER_SEC + 600;
+    weatherStep("fresh_again", weather, weather.fetchedAt);
+
+    if (compareDir) {
+        printf("%d of %d frames differ from %s\n", mismatches, stepNumber, compareDir);
+    }
+    return mismatches ? 1 : 0;
+}
+#endif
@@ -0,0 +1,238 @@
+#include "deferred_log.h"
+
+#include "Arduino.h"
+#include <atomic>
+
+#define LOG_RING_MASK (LOG_RING_SIZE - 1)
+#define LOG_HEADER_BYTES 12
+#define LOG_TEXT_MAX 256
+
+// Producers reserve space by advancing head with a CAS, fill it in, then
+// publish it by writing the (non-zero) header word last. The consumer
+// zeroes each record it takes, so an unwritten header always reads 0.
+static uint8_t ring[LOG_RING_SIZE] __attribute__((aligned(4)));
+static std::atomic<uint32_t> head(0);
+static std::atomic<uint32_t> tail(0);
+static std::atomic<uint32_t> dropped(0);
+
+// Serializes the consumers (drain task and logFlush); producers never wait
+static SemaphoreHandle_t drainLock = NULL;
+
+static void copyIn(uint32_t pos, const uint8_t* src, size_t n) {
+    size_t offset = pos & LOG_RING_MASK;
+    size_t first = n < LOG_RING_SIZE - offset ? n : LOG_RING_SIZE - offset;
+    memcpy(ring + offset, src, first);
+    memcpy(ring, src + first, n - first);
+}
+
+static void copyOut(uint8_t* dst, uint32_t pos, size_t n) {
+    size_t offset = pos & LOG_RING_MASK;
+    size_t first = n < LOG_RING_SIZE - offset ? n : LOG_RING_SIZE - offset;
+    memcpy(dst, ring + offset, first);
+    memcpy(dst + first, ring, n - first);
+}
+
+static void zeroRange(uint32_t pos, size_t n) {
+    size_t offset = pos & LOG_RING_MASK;
+    size_t first = n < LOG_RING_SIZE - offset ? n : LOG_RING_SIZE - offset;
+    memset(ring + offset, 0, first);
+    memset(ring, 0, n - first);
+}
+
+// ----------------------------------------
+// Producer side
+// ----------------------------------------
+
+LogRecord::LogRecord(uint8_t level, const char* format) {
+    uint32_t words[2] = {(uint32_t)(uintptr_t)format, (uint32_t)millis()};
+    buf[0] = level;
+    memcpy(buf + 4, words, sizeof(words));
+    len = LOG_HEADER_BYTES;
+}
+
+void LogRecord::put(int64_t value, bool wide) {
+    size_t bytes = wide ? 8 : 4;
+    if (full || len + 1 + bytes + 1 > sizeof(buf)) {
+        full = true;
+        return;
+    }
+    buf[len++] = wide ? LOG_TAG_INT64 : LOG_TAG_INT32;
+    if (wide) {
+        memcpy(buf + len, &value, 8);
+    } else {
+        int32_t narrow = (int32_t)value;
+        memcpy(buf + len, &narrow, 4);
+    }
+    len += bytes;
+}
+
+void LogRecord::put(double value) {
+    if (full || len + 1 + 8 + 1 > sizeof(buf)) {
+        full = true;
+        return;
+    }
+    buf[len++] = LOG_TAG_DOUBLE;
+    memcpy(buf + len, &value, 8);
+    len += 8;
+}
+
+void LogRecord::put(const char* value) {
+    if (!value) value = "(null)";
+    size_t n = strnlen(value, LOG_MAX_STRING);
+    if (full || len + 2 + n + 1 > sizeof(buf)) {
+        full = true;
+        return;
+    }
+    buf[len++] = LOG_TAG_STRING;
+    buf[len++] = (uint8_t)n;
+    memcpy(buf + len, value, n);
+    len += n;
+}
+
+void LogRecord::commit() {
+    buf[len++] = LOG_TAG_END;
+    uint32_t size = (len + 3) & ~3u;
+    while (len < size) buf[len++] = 0;
+    uint32_t header = size | (uint32_t)buf[0] << 16 | (uint32_t)LOG_RECORD_MARKER << 24;
+
+    uint32_t h = head.load(std::memory_order_relaxed);
+    do {
+        if (h + size - tail.load(std::memory_order_acquire) > LOG_RING_SIZE) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    } while (!head.compare_exchange_weak(h, h + size, std::memory_order_acq_rel,
+                                         std::memory_order_relaxed));
+
+    // Records are multiples of 4 and the ring a power of two, so a
+    // header word never wraps
+    copyIn(h + 4, buf + 4, size - 4);
+    __atomic_store_n((uint32_t*)(ring + (h & LOG_RING_MASK)), header, __ATOMIC_RELEASE);
+}
+
+// ----------------------------------------
+// Consumer side
+// ----------------------------------------
+
+// printf one record's format with its recorded arguments. Length
+// modifiers in the format are ignored: the argument tags carry the width.
+static size_t formatRecord(const uint8_t* rec, size_t size, char* out, size_t outSize) {
+    uint32_t formatAddr;
+    memcpy(&formatAddr, rec + 4, 4);
+    const char* fmt = (const char*)(uintptr_t)formatAddr;
+    const uint8_t* arg = rec + LOG_HEADER_BYTES;
+    const uint8_t* end = rec + size;
+    size_t n = 0;
+
+    while (*fmt && n + 1 < outSize) {
+        if (*fmt != '%') {
+            out[n++] = *fmt++;
+            continue;
+        }
+        if (fmt[1] == '%') {
+            out[n++] = '%';
+            fmt += 2;
+            continue;
+        }
+
+        char spec[16];
+        size_t s = 0;
+        spec[s++] = *fmt++;
+        while (*fmt && strchr("-+ #0123456789.", *fmt) && s < sizeof(spec) - 4) spec[s++] = *fmt++;
+        while (*fmt && strchr("hlLqjzt", *fmt)) fmt++;
+        char conv = *fmt;
+        if (!conv) break;
+        fmt++;
+
+        bool isFloat = strchr("fFeEgGaA", conv) != nullptr;
+        uint8_t tag = arg < end ? *arg++ : LOG_TAG_END;
+        size_t room = outSize - n;
+        int written;
+        if (tag == LOG_TAG_INT32 && !isFloat && conv != 's') {
+            int32_t v;
+            memcpy(&v, arg, 4);
+            arg += 4;
+            if (conv == 'p') conv = 'x';
+            spec[s++] = conv;
+            spec[s] = '\0';
+            written = snprintf(out + n, room, spec, v);
+        } else if (tag == LOG_TAG_INT64 && !isFloat && conv != 's') {
+            int64_t v;
+            memcpy(&v, arg, 8);
+            arg += 8;
+            spec[s++] = 'l';
+            spec[s++] = 'l';
+            spec[s++] = conv;
+            spec[s] = '\0';
+            written = snprintf(out + n, room, spec, (long long)v);
+        } else if (tag == LOG_TAG_DOUBLE && isFloat) {
+            double v;
+            memcpy(&v, arg, 8);
+            arg += 8;
+            spec[s++] = conv;
+            spec[s] = '\0';
+            written = snprintf(out + n, room, spec, v);
+        } else if (tag == LOG_TAG_STRING && conv == 's') {
+            char text[LOG_MAX_STRING + 1];
+            size_t len = *arg++;
+            memcpy(text, arg, len);
+            text[len] = '\0';
+            arg += len;
+            spec[s++] = 's';
+            spec[s] = '\0';
+            written = snprintf(out + n, room, spec, text);
+        } else {
+            // Missing (record was full) or doesn't match the format
+            written = snprintf(out + n, room, "?");
+            arg = end;
+        }
+        if (written > 0) n += (size_t)written < room ? written : room - 1;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+// Take one published record; false if there is none (yet)
+static bool drainOne() {
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return false;
+    uint32_t header = __atomic_load_n((uint32_t*)(ring + (t & LOG_RING_MASK)), __ATOMIC_ACQUIRE);
+    if (header == 0) return false;   // Reserved, still being written
+
+    uint8_t rec[LOG_MAX_RECORD];
+    size_t size = header & 0xffff;
+    copyOut(rec, t, size);
+    zeroRange(t, size);
+    tail.store(t + size, std::memory_order_release);
+
+#if LOG_BINARY_OUTPUT
+    Serial.write(rec, size);
+#else
+    char text[LOG_TEXT_MAX];
+    size_t len = formatRecord(rec, size, text, sizeof(text));
+    Serial.write((const uint8_t*)text, len);
+#endif
+    return true;
+}
+
+void logFlush() {
+    if (drainLock) xSemaphoreTake(drainLock, portMAX_DELAY);
+    while (drainOne()) {}
+    uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+    if (lost) Serial.printf("(log: %u records dropped, ring full)\n", (unsigned)lost);
+    if (drainLock) xSemaphoreGive(drainLock);
+}
+
+static void logTask(void* param) {
+    for (;;) {
+        logFlush();
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_INTERVAL_MS));
+    }
+}
+
+void logBegin() {
+    if (drainLock) return;
+    drainLock = xSemaphoreCreateMutex();
+    xTaskCreatePinnedToCore(logTask, "log", LOG_TASK_STACK, NULL, LOG_TASK_PRIORITY, NULL,
+                            LOG_TASK_CORE);
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+
+// ========================================
+// Deferred Binary Log
+// ========================================
+// LOG_INFO("Fetched %d days in %lu ms\n", days, ms) does no formatting
+// and never waits on the UART. It copies the format string's address,
+// a timestamp and the raw arguments into a compact record (strings are
+// copied, truncated to LOG_MAX_STRING) and appends it to a lock-free
+// ring buffer. A low-priority task drains the ring and does the
+// printf work, so logging stays out of the refresh path's latency.
+// Records that don't fit are dropped and counted; nothing blocks.
+//
+// Format strings must be literals (their address is the record's id).
+// Levels above LOG_LEVEL are compiled out entirely, arguments included.
+//
+// With LOG_BINARY_OUTPUT the drain task writes the raw records instead
+// of text: tools/log_decode.py turns a capture back into text using the
+// firmware ELF to look up each format string by its address.
+
+#define LOG_LEVEL_NONE   0
+#define LOG_LEVEL_ERROR  1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_INFO   3
+#define LOG_LEVEL_DEBUG  4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#ifndef LOG_BINARY_OUTPUT
+#define LOG_BINARY_OUTPUT 0
+#endif
+
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE        4096   // Bytes, power of two
+#endif
+#define LOG_MAX_RECORD       160    // Bytes, header included
+#define LOG_MAX_STRING       32     // Longer %s arguments are truncated
+#define LOG_DRAIN_INTERVAL_MS 200
+#define LOG_TASK_CORE        1
+#define LOG_TASK_STACK       3072
+#define LOG_TASK_PRIORITY    1      // Below the UI task
+
+// Record layout (all little endian), padded to a multiple of 4 bytes:
+//   u32 header   length (bits 0-15), level (16-23), LOG_RECORD_MARKER (24-31)
+//   u32 format   address of the format string
+//   u32 millis
+//   args         tag byte + payload each, then LOG_TAG_END
+#define LOG_RECORD_MARKER  0xA5
+#define LOG_TAG_END        0
+#define LOG_TAG_INT32      'i'   // 4 bytes
+#define LOG_TAG_INT64      'l'   // 8 bytes
+#define LOG_TAG_DOUBLE     'd'   // 8 bytes
+#define LOG_TAG_STRING     's'   // u8 length + bytes
+
+// Start the drain task
+void logBegin();
+
+// Format and print everything recorded so far from the calling task
+// (e.g. before deep sleep)
+void logFlush();
+
+// Builds one record on the stack
+class LogRecord {
+public:
+    LogRecord(uint8_t level, const char* format);
+    void put(int64_t value, bool wide);
+    void put(double value);
+    void put(const char* value);
+    void commit();
+
+private:
+    uint8_t buf[LOG_MAX_RECORD];
+    size_t len;
+    bool full = false;
+};
+
+// Argument encoding by type: integers by width, floats as double, C
+// strings copied, other pointers as integers
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+logPut(LogRecord& rec, T value) {
+    rec.put((int64_t)value, sizeof(T) > 4);
+}
+template <typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+logPut(LogRecord& rec, T value) {
+    rec.put((double)value);
+}
+inline void logPut(LogRecord& rec, const char* value) { rec.put(value); }
+inline void logPut(LogRecord& rec, char* value) { rec.put((const char*)value); }
+template <typename T>
+inline void logPut(LogRecord& rec, const T* value) { rec.put((int64_t)(uintptr_t)value, false); }
+
+inline void logPutAll(LogRecord&) {}
+template <typename T, typename... Rest>
+inline void logPutAll(LogRecord& rec, T value, Rest... rest) {
+    logPut(rec, value);
+    logPutAll(rec, rest...);
+}
+
+template <typename... Args>
+inline void logWrite(uint8_t level, const char* format, Args... args) {
+    LogRecord rec(level, format);
+    logPutAll(rec, args...);
+    rec.commit();
+}
+
+// "" fmt only compiles for a string literal
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) logWrite(LOG_LEVEL_ERROR, "" fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) logWrite(LOG_LEVEL_WARN, "" fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) logWrite(LOG_LEVEL_INFO, "" fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) do {} while (0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) logWrite(LOG_LEVEL_DEBUG, "" fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) do {} while (0)
+#endif
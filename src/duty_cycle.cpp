@@ -0,0 +1,110 @@
+#include "duty_cycle.h"
+
+#include "Arduino.h"
+#include <sys/time.h>
+#include "snapshot_store.h"
+#include "pin_config.h"
+#include "esp_sleep.h"
+#include "esp_rom_crc.h"
+#include "driver/gpio.h"
+#include "deferred_log.h"
+
+#define DUTY_CYCLE_MAGIC 0x44435943  // "DCYC"
+
+// Survives deep sleep (but not power loss or reset); crc covers every
+// byte before it
+struct DutyCycleState {
+    uint32_t magic;
+    SnapshotRecord snapshot;
+    PosixTz zone;
+    uint8_t zoneValid;
+    uint8_t hasSnapshot;
+    int64_t sleepStartedAt;  // Wall clock when we went to sleep
+    uint32_t sleepMs;        // Planned length of that sleep
+    uint32_t wakeCount;
+    uint64_t totalAwakeMs;   // Since the last cold boot
+    uint64_t totalSleepMs;
+    uint32_t crc;
+};
+
+RTC_DATA_ATTR static DutyCycleState rtcState;
+
+// Pins that keep the panel powered and deselected while the SoC sleeps
+static const int LATCHED_PINS[] = {PIN_POWER_ON, PIN_LCD_BL, PIN_LCD_RES, PIN_LCD_CS, PIN_LCD_RD};
+
+static uint32_t stateCrc() {
+    return esp_rom_crc32_le(0, (const uint8_t*)&rtcState, offsetof(DutyCycleState, crc));
+}
+
+bool dutyCycleRestore(WeatherSnapshot& weather, Location& location, PosixTz& zone, bool& zoneValid) {
+    bool timerWake = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+    if (!timerWake || rtcState.magic != DUTY_CYCLE_MAGIC || rtcState.crc != stateCrc()) {
+        // Cold boot: RTC memory holds garbage, start the statistics over
+        memset(&rtcState, 0, sizeof(rtcState));
+        return false;
+    }
+
+    rtcState.wakeCount++;
+    rtcState.totalSleepMs += rtcState.sleepMs;
+
+    // The RTC timer normally keeps system time across deep sleep; if it
+    // was lost anyway, carry on from when we went to sleep
+    if (time(nullptr) < rtcState.sleepStartedAt) {
+        struct timeval tv = {(time_t)(rtcState.sleepStartedAt + rtcState.sleepMs / 1000), 0};
+        settimeofday(&tv, nullptr);
+    }
+
+    if (!rtcState.hasSnapshot || !unpackSnapshot(rtcState.snapshot, weather, location)) {
+        return false;
+    }
+    weather.restored = false;  // Our own last fetch, not an old boot snapshot
+    zone = rtcState.zone;
+    zoneValid = rtcState.zoneValid;
+    return true;
+}
+
+void dutyCycleReleaseDisplay() {
+    for (size_t i = 0; i < sizeof(LATCHED_PINS) / sizeof(LATCHED_PINS[0]); i++) {
+        gpio_hold_dis((gpio_num_t)LATCHED_PINS[i]);
+    }
+    gpio_deep_sleep_hold_dis();
+}
+
+void dutyCycleSave(const WeatherSnapshot& weather, const Location& location,
+                   const PosixTz& zone, bool zoneValid) {
+    packSnapshot(weather, location, rtcState.snapshot);
+    rtcState.zone = zone;
+    rtcState.zoneValid = zoneValid;
+    rtcState.hasSnapshot = true;
+}
+
+void dutyCycleSleep(uint32_t sleepSec) {
+    uint32_t awakeMs = millis();
+    rtcState.totalAwakeMs += awakeMs;
+
+    uint64_t totalMs = rtcState.totalAwakeMs + rtcState.totalSleepMs;
+    float awakeShare = (float)rtcState.totalAwakeMs / totalMs;
+    float averageMa = DUTY_AWAKE_CURRENT_MA * awakeShare + DUTY_SLEEP_CURRENT_MA * (1.0f - awakeShare);
+    Serial.printf("Duty cycle: awake %lu ms this wake, %u wakes, %.2f%% awake overall, "
+                  "est. average %.1f mA (mAh per hour)\n",
+                  (unsigned long)awakeMs, (unsigned)rtcState.wakeCount,
+                  awakeShare * 100.0f, averageMa);
+    logFlush();
+    Serial.printf("Deep sleep for %u s\n", (unsigned)sleepSec);
+    Serial.flush();
+
+    rtcState.magic = DUTY_CYCLE_MAGIC;
+    rtcState.sleepStartedAt = time(nullptr);
+    rtcState.sleepMs = sleepSec * 1000;
+    rtcState.crc = stateCrc();
+
+    // Keep the panel powered and deselected so it holds its frame
+    digitalWrite(PIN_LCD_BL, DEEP_SLEEP_KEEP_BACKLIGHT ? HIGH : LOW);
+    for (size_t i = 0; i < sizeof(LATCHED_PINS) / sizeof(LATCHED_PINS[0]); i++) {
+        gpio_hold_en((gpio_num_t)LATCHED_PINS[i]);
+    }
+    gpio_deep_sleep_hold_en();
+
+    esp_sleep_enable_timer_wakeup((uint64_t)sleepSec * 1000000ULL);
+    esp_deep_sleep_start();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "weather_types.h"
+#include "posix_tz.h"
+
+// ========================================
+// Deep-Sleep Duty Cycle
+// ========================================
+// Optional mode (DEEP_SLEEP_MODE in main.cpp) in which the device
+// deep-sleeps between refreshes instead of idling with WiFi up. The last
+// forecast, location, zone rules and wall-clock time are kept in RTC
+// memory, and the LCD power, backlight, reset and chip-select pins are
+// latched so the ST7789 keeps showing its last frame while the SoC
+// sleeps. A timer wake then skips the cold boot path.
+
+#ifndef DEEP_SLEEP_KEEP_BACKLIGHT
+#define DEEP_SLEEP_KEEP_BACKLIGHT   1         // 0: panel keeps its frame but goes dark
+#endif
+#ifndef DEEP_SLEEP_RENDER_WAIT_MS
+#define DEEP_SLEEP_RENDER_WAIT_MS   5000      // Max wait for the UI to draw before sleeping
+#endif
+
+// Rough board currents for the average-current estimate (measure yours)
+#ifndef DUTY_AWAKE_CURRENT_MA
+#define DUTY_AWAKE_CURRENT_MA       110.0f    // CPU + WiFi + backlight
+#endif
+#ifndef DUTY_SLEEP_CURRENT_MA
+#if DEEP_SLEEP_KEEP_BACKLIGHT
+#define DUTY_SLEEP_CURRENT_MA       25.0f     // Mostly the backlight
+#else
+#define DUTY_SLEEP_CURRENT_MA       1.5f      // Panel + LDO quiescent
+#endif
+#endif
+
+// After a timer wake, restore the state saved before sleeping. Returns
+// false on a cold boot (power-on, reset, flash) or if RTC memory doesn't
+// hold a valid record. Display pins stay latched until
+// dutyCycleReleaseDisplay().
+bool dutyCycleRestore(WeatherSnapshot& weather, Location& location, PosixTz& zone, bool& zoneValid);
+
+// Un-latch the display pins once the display driver has taken them over
+void dutyCycleReleaseDisplay();
+
+// Copy the state to RTC memory; call after each successful fetch
+void dutyCycleSave(const WeatherSnapshot& weather, const Location& location,
+                   const PosixTz& zone, bool zoneValid);
+
+// Log the duty-cycle statistics, latch the display and deep-sleep for
+// sleepSec. Does not return.
+void dutyCycleSleep(uint32_t sleepSec);
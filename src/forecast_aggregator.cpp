@@ -0,0 +1,161 @@
+#include "forecast_aggregator.h"
+#include "text_format.h"
+
+#include <string.h>
+
+static const int32_t SECONDS_PER_DAY = 86400;
+
+// Midday window used to pick the representative description (12:00-15:00)
+static const int32_t MIDDAY_START_MIN = 12 * 60;
+static const int32_t MIDDAY_END_MIN = 15 * 60;
+
+int32_t dayNumberFromEpoch(int64_t localEpoch) {
+    int64_t days = localEpoch / SECONDS_PER_DAY;
+    if (localEpoch % SECONDS_PER_DAY < 0) days--;
+    return (int32_t)days;
+}
+
+int32_t minuteOfDayFromEpoch(int64_t localEpoch) {
+    int64_t secs = localEpoch % SECONDS_PER_DAY;
+    if (secs < 0) secs += SECONDS_PER_DAY;
+    return (int32_t)(secs / 60);
+}
+
+CivilDate civilFromDayNumber(int32_t dayNumber) {
+    // Howard Hinnant's civil_from_days: shift the epoch to 0000-03-01 so
+    // leap days fall at the end of each 400-year era
+    int32_t z = dayNumber + 719468;
+    int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);                       // [0, 146096]
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  // [0, 399]
+    int32_t y = (int32_t)yoe + era * 400;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);            // [0, 365]
+    uint32_t mp = (5 * doy + 2) / 153;                                 // [0, 11]
+    uint32_t d = doy - (153 * mp + 2) / 5 + 1;                         // [1, 31]
+    uint32_t m = mp < 10 ? mp + 3 : mp - 9;                            // [1, 12]
+
+    CivilDate date;
+    date.year = y + (m <= 2);
+    date.month = (uint8_t)m;
+    date.day = (uint8_t)d;
+    return date;
+}
+
+int weekdayFromDayNumber(int32_t dayNumber) {
+    // 1970-01-01 was a Thursday
+    int32_t wd = (dayNumber + 4) % 7;
+    return wd < 0 ? wd + 7 : wd;
+}
+
+const char* weekdayName(int32_t dayNumber) {
+    static const char* const days[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    return days[weekdayFromDayNumber(dayNumber)];
+}
+
+void ForecastAggregator::begin(int64_t nowUtc, int32_t utcOffset) {
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+        DayAccumulator& d = days[i];
+        d.dayNumber = 0;
+        d.hasDate = false;
+        d.entryCount = 0;
+        d.tempHigh = INT16_MIN;
+        d.tempLow = INT16_MAX;
+        d.humiditySum = 0;
+        d.description[0] = '\0';
+    }
+    days[0].dayNumber = dayNumberFromEpoch(nowUtc + utcOffset);
+    days[0].hasDate = true;
+}
+
+void ForecastAggregator::add(int64_t dtUtc, int32_t utcOffset, int16_t tempTenths, int humidity,
+                             const char* description) {
+    int64_t local = dtUtc + utcOffset;
+    int32_t dayNum = dayNumberFromEpoch(local);
+
+    // Today goes to slot 0; the next two distinct dates claim slots 1 and 2
+    int index = -1;
+    for (int i = 0; i < FORECAST_DAYS; i++) {
+        if (!days[i].hasDate) {
+            days[i].dayNumber = dayNum;
+            days[i].hasDate = true;
+            index = i;
+            break;
+        }
+        if (days[i].dayNumber == dayNum) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) return;  // Beyond 3 days
+
+    DayAccumulator& d = days[index];
+    if (tempTenths > d.tempHigh) d.tempHigh = tempTenths;
+    if (tempTenths < d.tempLow) d.tempLow = tempTenths;
+    d.humiditySum += humidity;
+    d.entryCount++;
+
+    // First description of the day, replaced by any midday entry
+    int32_t minute = minuteOfDayFromEpoch(local);
+    bool midday = minute >= MIDDAY_START_MIN && minute <= MIDDAY_END_MIN;
+    if (description && (d.description[0] == '\0' || midday)) {
+        strncpy(d.description, description, FORECAST_DESC_LEN - 1);
+        d.description[FORECAST_DESC_LEN - 1] = '\0';
+    }
+}
+
+void ForecastAggregator::finish() {
+    for (int i = 1; i < FORECAST_DAYS; i++) {
+        if (!days[i].hasDate) {
+            days[i].dayNumber = days[i - 1].dayNumber + 1;
+            days[i].hasDate = true;
+        }
+    }
+}
+
+int ForecastAggregator::averageHumidity(int index) const {
+    const DayAccumulator& d = days[index];
+    return d.entryCount > 0 ? (int)(d.humiditySum / d.entryCount) : 0;
+}
+
+static void copyText(char* dst, const char* src, size_t size) {
+    strncpy(dst, src, size - 1);
+    dst[size - 1] = '\0';
+}
+
+void fillForecastDays(const ForecastAggregator& aggregator, const DailyPoint* daily,
+                      int dailyCount, int16_t currentTemp, WeatherDay out[FORECAST_DAYS]) {
+    for (int day = 0; day < FORECAST_DAYS; day++) {
+        DayAccumulator acc = aggregator.day(day);
+        bool hasData = acc.entryCount > 0;
+        for (int i = 0; i < dailyCount; i++) {
+            if (daily[i].dayNumber != acc.dayNumber) continue;
+            acc.tempHigh = daily[i].tempHigh;
+            acc.tempLow = daily[i].tempLow;
+            if (daily[i].description[0]) {
+                copyText(acc.description, daily[i].description, sizeof(acc.description));
+            }
+            hasData = true;
+        }
+
+        WeatherDay& d = out[day];
+        CivilDate date = civilFromDayNumber(acc.dayNumber);
+        copyText(d.day_name, weekdayName(acc.dayNumber), sizeof(d.day_name));
+        TextBuilder(d.date, sizeof(d.date)).twoDigits(date.month).chr('-').twoDigits(date.day);
+        copyText(d.description, acc.description, sizeof(d.description));
+        d.humidity = (uint8_t)aggregator.averageHumidity(day);
+
+        if (!hasData) {
+            // Late in the day nothing is left of today but the current
+            // reading; future days show 0/0
+            d.temp_high = day == 0 ? currentTemp : 0;
+            d.temp_low = day == 0 ? currentTemp : 0;
+            continue;
+        }
+        d.temp_high = acc.tempHigh;
+        d.temp_low = acc.tempLow;
+        // Past the forecast peak (or trough), today's range still has to
+        // include what it is now
+        if (day == 0 && currentTemp > d.temp_high) d.temp_high = currentTemp;
+        if (day == 0 && currentTemp < d.temp_low) d.temp_low = currentTemp;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include "weather_types.h"
+
+// ========================================
+// Forecast Aggregation Engine
+// ========================================
+// Folds the 3-hour forecast entries into per-calendar-day min/max,
+// humidity and a representative (midday) description in a single pass.
+// All calendar math is done on integer day numbers, so there are no
+// gmtime/strftime/mktime calls and no heap allocations. Plain C++ only;
+// nothing here depends on Arduino.
+
+#define FORECAST_DAYS      3   // Today + 2 following days
+#define FORECAST_DESC_LEN  32  // Longest OWM description is ~28 chars
+
+struct CivilDate {
+    int32_t year;
+    uint8_t month;  // 1-12
+    uint8_t day;    // 1-31
+};
+
+// Days since 1970-01-01 for a local epoch time (floors for negative values)
+int32_t dayNumberFromEpoch(int64_t localEpoch);
+
+// Minutes since local midnight for a local epoch time
+int32_t minuteOfDayFromEpoch(int64_t localEpoch);
+
+// Year/month/day for a day number (proleptic Gregorian calendar)
+CivilDate civilFromDayNumber(int32_t dayNumber);
+
+// 0 = Sunday ... 6 = Saturday
+int weekdayFromDayNumber(int32_t dayNumber);
+
+// Three-letter English day name ("Sun" ... "Sat")
+const char* weekdayName(int32_t dayNumber);
+
+struct DayAccumulator {
+    int32_t dayNumber;       // Local day number this slot covers
+    bool hasDate;            // False until an entry (or today) claims the slot
+    uint8_t entryCount;
+    int16_t tempHigh;        // Tenths of a degree
+    int16_t tempLow;
+    int32_t humiditySum;
+    char description[FORECAST_DESC_LEN];
+};
+
+class ForecastAggregator {
+public:
+    // Reset all slots; slot 0 is pinned to the local day containing nowUtc
+    // (utcOffset is the offset in effect at nowUtc)
+    void begin(int64_t nowUtc, int32_t utcOffset);
+
+    // Fold one forecast entry into its day slot, using the UTC offset in
+    // effect at dtUtc. Entries beyond the third distinct calendar day are
+    // ignored.
+    void add(int64_t dtUtc, int32_t utcOffset, int16_t tempTenths, int humidity,
+             const char* description);
+
+    // Give empty future slots consecutive dates so they still get a label
+    void finish();
+
+    const DayAccumulator& day(int index) const { return days[index]; }
+
+    // Average humidity for a slot, 0 when it has no entries
+    int averageHumidity(int index) const;
+
+private:
+    DayAccumulator days[FORECAST_DAYS];
+};
+
+// Fill the display days from the aggregated slots. Where the provider
+// aggregated a day itself (matched by day number), its high, low and
+// description win; humidity always comes from the hours. Day 0 is
+// widened to include the current temperature, or takes it outright when
+// no hours of today are left. Later days without data read 0/0.
+void fillForecastDays(const ForecastAggregator& aggregator, const DailyPoint* daily,
+                      int dailyCount, int16_t currentTemp, WeatherDay out[FORECAST_DAYS]);
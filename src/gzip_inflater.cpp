@@ -0,0 +1,173 @@
+#include "gzip_inflater.h"
+
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "rom/miniz.h"
+
+// Header flags (RFC 1952)
+#define GZIP_FHCRC    0x02
+#define GZIP_FEXTRA   0x04
+#define GZIP_FNAME    0x08
+#define GZIP_FCOMMENT 0x10
+
+struct GzipInflater::Decoder {
+    tinfl_decompressor tinfl;
+};
+
+// PSRAM if the board has it, internal RAM otherwise
+static void* allocLarge(size_t size) {
+    void* p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    return p ? p : heap_caps_malloc(size, MALLOC_CAP_8BIT);
+}
+
+bool GzipInflater::ready() {
+    if (decoder && window) return true;
+    if (!decoder) decoder = (Decoder*)allocLarge(sizeof(Decoder));
+    if (!window) window = (uint8_t*)allocLarge(TINFL_LZ_DICT_SIZE);
+    return decoder && window;
+}
+
+void GzipInflater::begin(GzipSource newSource, void* ctx) {
+    source = newSource;
+    sourceCtx = ctx;
+    tinfl_init(&decoder->tinfl);
+    inLen = inPos = 0;
+    inputEnded = false;
+    outPos = readPos = readEnd = 0;
+    crc = 0;
+    outTotal = 0;
+    headerDone = false;
+    inflateDone = false;
+    done = false;
+    error = false;
+}
+
+int GzipInflater::inputByte() {
+    if (inPos >= inLen) {
+        if (inputEnded) return -1;
+        inLen = source(sourceCtx, in, sizeof(in));
+        inPos = 0;
+        if (inLen == 0) {
+            inputEnded = true;
+            return -1;
+        }
+    }
+    return in[inPos++];
+}
+
+// File name and comment fields
+bool GzipInflater::skipString() {
+    int c;
+    while ((c = inputByte()) > 0) {}
+    return c == 0;
+}
+
+bool GzipInflater::parseHeader() {
+    uint8_t h[10];
+    for (int i = 0; i < 10; i++) {
+        int c = inputByte();
+        if (c < 0) return false;
+        h[i] = c;
+    }
+    // Magic, and deflate is the only method there is
+    if (h[0] != 0x1f || h[1] != 0x8b || h[2] != 8) return false;
+    uint8_t flags = h[3];
+
+    if (flags & GZIP_FEXTRA) {
+        int lo = inputByte();
+        int hi = inputByte();
+        if (lo < 0 || hi < 0) return false;
+        for (int n = lo | (hi << 8); n > 0; n--) {
+            if (inputByte() < 0) return false;
+        }
+    }
+    if ((flags & GZIP_FNAME) && !skipString()) return false;
+    if ((flags & GZIP_FCOMMENT) && !skipString()) return false;
+    if (flags & GZIP_FHCRC) {
+        if (inputByte() < 0 || inputByte() < 0) return false;
+    }
+    return true;
+}
+
+// Run the decoder until it produces output; false at the end or on error
+bool GzipInflater::inflateMore() {
+    for (;;) {
+        if (inPos >= inLen && !inputEnded) {
+            inLen = source(sourceCtx, in, sizeof(in));
+            inPos = 0;
+            if (inLen == 0) inputEnded = true;
+        }
+
+        // The window is the output buffer; tinfl wraps around it itself
+        size_t inAvail = inLen - inPos;
+        size_t outAvail = TINFL_LZ_DICT_SIZE - outPos;
+        tinfl_status status = tinfl_decompress(&decoder->tinfl, in + inPos, &inAvail,
+                                               window, window + outPos, &outAvail,
+                                               inputEnded ? 0 : TINFL_FLAG_HAS_MORE_INPUT);
+        inPos += inAvail;
+
+        if (outAvail > 0) {
+            readPos = outPos;
+            readEnd = outPos + outAvail;
+            crc = esp_rom_crc32_le(crc, window + outPos, outAvail);
+            outTotal += outAvail;
+            outPos = (outPos + outAvail) & (TINFL_LZ_DICT_SIZE - 1);
+        }
+        if (status == TINFL_STATUS_DONE) {
+            inflateDone = true;
+            return outAvail > 0;
+        }
+        if (status < 0 || (status == TINFL_STATUS_NEEDS_MORE_INPUT && inputEnded)) {
+            error = true;
+            return false;
+        }
+        if (outAvail > 0) return true;
+    }
+}
+
+// CRC-32 and length of the inflated data, little endian. tinfl reads
+// ahead, so the first trailer bytes may already sit in its bit buffer.
+bool GzipInflater::checkTrailer() {
+    tinfl_bit_buf_t bits = decoder->tinfl.m_bit_buf;
+    mz_uint32 numBits = decoder->tinfl.m_num_bits;
+    bits >>= numBits & 7;    // Padding to the end of the last deflate byte
+    numBits -= numBits & 7;
+
+    uint8_t trailer[8];
+    for (int i = 0; i < 8; i++) {
+        int c;
+        if (numBits >= 8) {
+            c = bits & 0xff;
+            bits >>= 8;
+            numBits -= 8;
+        } else {
+            c = inputByte();
+        }
+        if (c < 0) return false;
+        trailer[i] = c;
+    }
+    uint32_t expectedCrc = trailer[0] | trailer[1] << 8 | trailer[2] << 16 |
+                           (uint32_t)trailer[3] << 24;
+    uint32_t expectedSize = trailer[4] | trailer[5] << 8 | trailer[6] << 16 |
+                            (uint32_t)trailer[7] << 24;
+    return expectedCrc == crc && expectedSize == outTotal;
+}
+
+int GzipInflater::read() {
+    if (readPos < readEnd) return window[readPos++];
+    if (done) return -1;
+
+    if (!headerDone) {
+        if (!parseHeader()) {
+            error = true;
+            done = true;
+            return -1;
+        }
+        headerDone = true;
+    }
+    if (!inflateDone && inflateMore()) return window[readPos++];
+
+    if (!error && !checkTrailer()) error = true;
+    done = true;
+    return -1;
+}
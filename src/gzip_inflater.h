@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ========================================
+// Streaming Gzip Inflater
+// ========================================
+// Inflates a gzip body (RFC 1952) one byte at a time with the tinfl
+// decoder in the ESP32 ROM, pulling compressed bytes from a callback as
+// it needs them. The only output buffer is the 32 KB deflate window: a
+// server may refer back that far, so a smaller one can't decode every
+// stream. Inflated bytes are read straight out of the window, so the
+// whole document never exists in memory at once.
+//
+// The decoder state and window are allocated once (PSRAM when the board
+// has it) and reused for every response. The trailer's CRC-32 and length
+// are checked against what was inflated.
+
+#define GZIP_INPUT_BUFFER 256    // Compressed bytes pulled per refill
+
+// Fills buf with up to size compressed bytes; returns the count, or 0 at
+// the end of the body
+typedef size_t (*GzipSource)(void* ctx, uint8_t* buf, size_t size);
+
+class GzipInflater {
+public:
+    // Allocate the decoder and window on first use; false if out of memory
+    bool ready();
+
+    // Start a new stream
+    void begin(GzipSource source, void* ctx);
+
+    // Next inflated byte, or -1 at the end of the stream or on error
+    int read();
+
+    bool failed() const { return error; }
+    uint32_t inflatedBytes() const { return outTotal; }
+
+private:
+    int inputByte();
+    bool skipString();
+    bool parseHeader();
+    bool checkTrailer();
+    bool inflateMore();
+
+    struct Decoder;
+    Decoder* decoder = nullptr;
+    uint8_t* window = nullptr;
+
+    GzipSource source = nullptr;
+    void* sourceCtx = nullptr;
+    uint8_t in[GZIP_INPUT_BUFFER];
+    size_t inLen = 0;
+    size_t inPos = 0;
+    bool inputEnded = false;
+
+    size_t outPos = 0;     // Where tinfl writes next in the window
+    size_t readPos = 0;    // Next inflated byte to hand out
+    size_t readEnd = 0;
+    uint32_t crc = 0;
+    uint32_t outTotal = 0;
+    bool headerDone = false;
+    bool inflateDone = false;   // Deflate stream ended, trailer unread
+    bool done = true;
+    bool error = false;
+};
@@ -0,0 +1,207 @@
+#include "hedged_fetch.h"
+
+#include "Arduino.h"
+#include "esp_sleep.h"
+#include "deferred_log.h"
+#include "refresh_scheduler.h"
+#include "request_budget.h"
+
+#define HEDGE_MAGIC 0x48454447  // "HEDG"
+
+struct SampleRing {
+    uint16_t ms[HEDGE_HISTORY];
+    uint8_t count;
+    uint8_t next;
+};
+
+// Survives deep sleep; reset on every cold boot
+struct HedgeState {
+    uint32_t magic;
+    SampleRing ttfb;          // Primary: fetch start (connect included) -> first byte
+    SampleRing receive;       // Primary: first byte -> report parsed
+    uint32_t fetches;
+    uint32_t hedges;          // Secondary was asked
+    uint32_t secondaryWins;   // ...and its report was used
+    uint32_t rescues;         // ...because the primary failed
+    uint32_t failures;        // Neither delivered
+    uint32_t savedMs;         // Lower bound, over all wins
+    uint32_t maxSavedMs;
+};
+
+RTC_DATA_ATTR static HedgeState rtcState;
+
+static void addSample(SampleRing& ring, uint32_t ms) {
+    ring.ms[ring.next] = (uint16_t)(ms < UINT16_MAX ? ms : UINT16_MAX);
+    ring.next = (ring.next + 1) % HEDGE_HISTORY;
+    if (ring.count < HEDGE_HISTORY) ring.count++;
+}
+
+// Nearest-rank percentile; 0 without samples
+static uint32_t percentile(const SampleRing& ring, uint8_t pct) {
+    if (ring.count == 0) return 0;
+    uint16_t sorted[HEDGE_HISTORY];
+    for (uint8_t i = 0; i < ring.count; i++) {
+        uint16_t value = ring.ms[i];
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1] > value; j--) sorted[j] = sorted[j - 1];
+        sorted[j] = value;
+    }
+    uint8_t rank = (ring.count * pct + 99) / 100;
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+// Poll until a response starts; 1 = first session, 2 = second (either
+// may be nullptr), 0 = neither within timeoutMs
+static int waitForFirstByte(HttpSession* first, HttpSession* second, uint32_t timeoutMs) {
+    unsigned long start = millis();
+    for (;;) {
+        if (first && first->responseStarted()) return 1;
+        if (second && second->responseStarted()) return 2;
+        if (millis() - start >= timeoutMs) return 0;
+        delay(HEDGE_POLL_MS);
+    }
+}
+
+void hedgeInit() {
+    bool timerWake = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+    if (!timerWake || rtcState.magic != HEDGE_MAGIC) {
+        memset(&rtcState, 0, sizeof(rtcState));
+        rtcState.magic = HEDGE_MAGIC;
+    }
+}
+
+uint32_t hedgeDelayMs() {
+    if (rtcState.ttfb.count < HEDGE_MIN_SAMPLES) return HEDGE_DEFAULT_DELAY_MS;
+    uint32_t delayMs = percentile(rtcState.ttfb, HEDGE_PERCENTILE);
+    if (delayMs < HEDGE_MIN_DELAY_MS) return HEDGE_MIN_DELAY_MS;
+    if (delayMs > HEDGE_MAX_DELAY_MS) return HEDGE_MAX_DELAY_MS;
+    return delayMs;
+}
+
+WeatherProvider* hedgedFetch(WeatherProvider& primary, HttpSession& primarySession,
+                             WeatherProvider& secondary, HttpSession& secondarySession,
+                             const Location& location, WeatherReport& report) {
+    rtcState.fetches++;
+    uint32_t delayMs = hedgeDelayMs();
+    unsigned long start = millis();
+
+    // The delay is measured from start like the samples it comes from, so
+    // connecting and writing the requests already used part of it
+    bool primaryOpen = primary.request(primarySession, location);
+    uint32_t spentMs = millis() - start;
+    uint32_t waitMs = spentMs < delayMs ? delayMs - spentMs : 0;
+    if (primaryOpen && waitForFirstByte(&primarySession, nullptr, waitMs) == 1) {
+        // The usual case: no hedge. A primary that answers and then fails
+        // is left to the regular retry.
+        unsigned long firstByte = millis();
+        addSample(rtcState.ttfb, firstByte - start);
+        if (!primary.receive(primarySession, report)) {
+            rtcState.failures++;
+            return nullptr;
+        }
+        addSample(rtcState.receive, millis() - firstByte);
+        return &primary;
+    }
+
+    if (!schedulerTakeWeatherCalls(secondary, false)) {
+        // No calls to spare: wait for the primary after all. Its time to
+        // first byte is only known to be over the delay.
+        LOG_WARN("Hedge: no API calls left for %s, waiting for %s\n", secondary.name(),
+                 primary.name());
+        if (primaryOpen) addSample(rtcState.ttfb, millis() - start);
+        if (primaryOpen && primary.receive(primarySession, report)) return &primary;
+        rtcState.failures++;
+        return nullptr;
+    }
+
+    rtcState.hedges++;
+    LOG_INFO("Hedge: %s %s after %lu ms, asking %s\n", primary.name(),
+             primaryOpen ? "silent" : "unreachable", millis() - start, secondary.name());
+    bool secondaryOpen = secondary.request(secondarySession, location);
+
+    // Race to the first byte, then read that one first. The other's
+    // response waits in its socket in case the first turns out invalid.
+    int first = 0;
+    if (primaryOpen || secondaryOpen) {
+        first = waitForFirstByte(primaryOpen ? &primarySession : nullptr,
+                                 secondaryOpen ? &secondarySession : nullptr, BUDGET_TTFB_MS);
+    }
+    unsigned long decidedAt = millis();
+    if (first == 1) addSample(rtcState.ttfb, decidedAt - start);
+
+    bool secondaryFirst = first == 2 || !primaryOpen;
+    WeatherProvider* order[2] = {&primary, &secondary};
+    HttpSession* sessions[2] = {&primarySession, &secondarySession};
+    bool open[2] = {primaryOpen, secondaryOpen};
+    if (secondaryFirst) {
+        order[0] = &secondary;
+        order[1] = &primary;
+        sessions[0] = &secondarySession;
+        sessions[1] = &primarySession;
+        open[0] = secondaryOpen;
+        open[1] = primaryOpen;
+    }
+
+    WeatherProvider* winner = nullptr;
+    bool primaryFailed = !primaryOpen;
+    for (int i = 0; i < 2 && !winner; i++) {
+        if (!open[i]) continue;
+        unsigned long readStart = millis();
+        if (order[i]->receive(*sessions[i], report)) {
+            winner = order[i];
+            if (winner == &primary) addSample(rtcState.receive, millis() - readStart);
+        } else if (order[i] == &primary) {
+            primaryFailed = true;
+        }
+    }
+    unsigned long doneAt = millis();
+
+    if (!winner) {
+        rtcState.failures++;
+        return nullptr;
+    }
+    if (winner == &primary) {
+        // Hedged for nothing this time
+        secondarySession.close();
+        LOG_INFO("Hedge: %s answered first, %s cancelled\n", primary.name(), secondary.name());
+        return &primary;
+    }
+
+    rtcState.secondaryWins++;
+    if (primaryFailed) {
+        rtcState.rescues++;
+        LOG_INFO("Hedge: %s failed, %s delivered\n", primary.name(), secondary.name());
+        return &secondary;
+    }
+
+    // The primary is still pending: it couldn't have finished before its
+    // first byte (no earlier than the race was decided, or now if it
+    // hasn't sent one) plus its median read time
+    bool primaryStarted = primarySession.responseStarted();
+    unsigned long primaryFirstByte = primaryStarted ? decidedAt : doneAt;
+    addSample(rtcState.ttfb, primaryFirstByte - start);
+    unsigned long primaryDoneAt = primaryFirstByte + percentile(rtcState.receive, 50);
+    uint32_t savedMs = (long)(primaryDoneAt - doneAt) > 0 ? primaryDoneAt - doneAt : 0;
+    rtcState.savedMs += savedMs;
+    if (savedMs > rtcState.maxSavedMs) rtcState.maxSavedMs = savedMs;
+    primarySession.close();
+    LOG_INFO("Hedge: %s won, %s cancelled, at least %u ms saved\n", secondary.name(),
+             primary.name(), savedMs);
+    return &secondary;
+}
+
+void hedgeDumpReport() {
+    const HedgeState& s = rtcState;
+    Serial.println("\n--- Hedged fetch ---");
+    Serial.printf("fetches %u, hedged %u (%.1f%%), secondary won %u (%u rescues), failed %u\n",
+                  (unsigned)s.fetches, (unsigned)s.hedges,
+                  s.fetches ? 100.0f * s.hedges / s.fetches : 0.0f, (unsigned)s.secondaryWins,
+                  (unsigned)s.rescues, (unsigned)s.failures);
+    uint32_t timedWins = s.secondaryWins - s.rescues;
+    Serial.printf("latency saved (lower bound): %u ms total, %u ms avg per win, %u ms max\n",
+                  (unsigned)s.savedMs, timedWins ? (unsigned)(s.savedMs / timedWins) : 0,
+                  (unsigned)s.maxSavedMs);
+    Serial.printf("delay %u ms: p%d of %u primary TTFB samples (p50 %u ms), read p50 %u ms\n",
+                  (unsigned)hedgeDelayMs(), HEDGE_PERCENTILE, (unsigned)s.ttfb.count,
+                  (unsigned)percentile(s.ttfb, 50), (unsigned)percentile(s.receive, 50));
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include "weather_provider.h"
+
+// ========================================
+// Hedged Weather Fetch
+// ========================================
+// Cuts the tail of refresh latency caused by one slow upstream. The
+// primary provider's requests go out first; if no response byte arrives
+// within the hedge delay, the same forecast is requested from the
+// secondary provider on a second session. Whichever starts answering
+// first is read and parsed; the first complete, valid report wins and
+// the other connection is dropped. If the first one fails, the other is
+// still read.
+//
+// The race is decided on the first byte on purpose, not on the first
+// complete body: the providers parse straight from the socket into the
+// one shared JSON arena and WeatherReport, so two bodies can't be read
+// side by side. A response that has started is nearly always the first
+// to finish, and the one that lost the race is the fallback.
+//
+// The delay is the HEDGE_PERCENTILE of the primary's recent times to
+// first byte, counted from the start of the fetch (connect and TLS
+// included), so only the slowest few percent of fetches are hedged.
+// Until there are HEDGE_MIN_SAMPLES it is HEDGE_DEFAULT_DELAY_MS. A hedge
+// costs secondary API calls, taken from the secondary's own daily call
+// budget; with none left the fetch just waits for the primary.
+//
+// Counters (fetches, hedge rate, wins, estimated latency saved) and the
+// samples survive deep sleep. Latency saved is a lower bound: when the
+// secondary wins, the primary could not have finished before its first
+// byte plus its median time to read and parse a response.
+
+#ifndef HEDGE_PERCENTILE
+#define HEDGE_PERCENTILE        95      // Of the primary's time to first byte
+#endif
+#ifndef HEDGE_DEFAULT_DELAY_MS
+#define HEDGE_DEFAULT_DELAY_MS  2000    // Until there are enough samples
+#endif
+#define HEDGE_MIN_DELAY_MS      250     // Never hedge sooner than this
+#define HEDGE_MAX_DELAY_MS      6000
+#define HEDGE_HISTORY           32      // Samples kept per series
+#define HEDGE_MIN_SAMPLES       8
+#define HEDGE_POLL_MS           5
+
+// Clear samples and counters on a cold boot; keep them over a timer wake
+void hedgeInit();
+
+// Fetch the report from primary, hedged with secondary. Returns the
+// provider whose report was used, nullptr if neither delivered. Each
+// provider uses only its own session.
+WeatherProvider* hedgedFetch(WeatherProvider& primary, HttpSession& primarySession,
+                             WeatherProvider& secondary, HttpSession& secondarySession,
+                             const Location& location, WeatherReport& report);
+
+// Current hedge delay
+uint32_t hedgeDelayMs();
+
+// Print the counters and the delay
+void hedgeDumpReport();
@@ -0,0 +1,528 @@
+#include "http_session.h"
+#include "phase_timer.h"
+#include "memory_monitor.h"
+#include "deferred_log.h"
+
+// ----------------------------------------
+// Response body stream
+// ----------------------------------------
+
+int HttpBodyStream::available() {
+    if (lookahead >= 0) return 1;
+    return done ? 0 : 1;
+}
+
+int HttpBodyStream::peek() {
+    if (lookahead < 0) {
+        lookahead = read();
+    }
+    return lookahead;
+}
+
+int HttpBodyStream::read() {
+    if (lookahead >= 0) {
+        int c = lookahead;
+        lookahead = -1;
+        return c;
+    }
+    if (done) return -1;
+
+    int c = gzip ? session->inflater.read() : readRaw();
+    if (c < 0) {
+        if (gzip) {
+            if (session->inflater.failed()) error = true;
+            // Anything after the gzip member is discarded
+            while (readRaw() >= 0) {}
+        }
+        done = true;
+        return -1;
+    }
+    bytesRead++;
+    return c;
+}
+
+// Next byte of the body as sent, with the transfer encoding removed
+int HttpBodyStream::readRaw() {
+    if (rawDone) return -1;
+
+    if (remaining == 0) {
+        if (!chunked || !nextChunk()) {
+            rawDone = true;
+            return -1;
+        }
+    }
+
+    int c = session->readByte();
+    if (c < 0) {
+        // Running out of data is only normal for read-until-close bodies
+        if (chunked || remaining > 0) error = true;
+        rawDone = true;
+        return -1;
+    }
+    if (remaining > 0) remaining--;
+    wireBytes++;
+    return c;
+}
+
+// Compressed input for the inflater: whatever has arrived, at least one
+// byte unless the body ended
+size_t HttpBodyStream::gzipSource(void* ctx, uint8_t* buf, size_t size) {
+    HttpBodyStream* body = (HttpBodyStream*)ctx;
+    size_t n = 0;
+    while (n < size) {
+        if (n > 0 && !body->session->transportBuffered()) break;
+        int c = body->readRaw();
+        if (c < 0) break;
+        buf[n++] = (uint8_t)c;
+    }
+    return n;
+}
+
+// Parse the next chunk-size line; false at the last chunk or on error
+bool HttpBodyStream::nextChunk() {
+    char line[32];
+    if (!firstChunk) {
+        // CRLF that terminates the previous chunk's data
+        if (!session->readLine(line, sizeof(line))) {
+            error = true;
+            return false;
+        }
+    }
+    firstChunk = false;
+
+    if (!session->readLine(line, sizeof(line))) {
+        error = true;
+        return false;
+    }
+    long size = strtol(line, nullptr, 16);
+    if (size <= 0) {
+        // Last chunk: skip any trailer headers up to the blank line
+        while (session->readLine(line, sizeof(line)) && line[0] != '\0') {}
+        return false;
+    }
+    remaining = size;
+    return true;
+}
+
+// ----------------------------------------
+// Session
+// ----------------------------------------
+
+bool HttpSession::connect(const char* newHost, uint16_t newPort, TlsChannel* newTls) {
+    bool sameHost = strcmp(host, newHost) == 0 && port == newPort && tls == newTls;
+    bool warm = sameHost && serverKeepsAlive && client.connected() &&
+                (!tls || tls->isOpen()) &&
+                millis() - lastUsedMs < HTTP_KEEPALIVE_IDLE_MS;
+    if (warm) {
+        connectionReused = true;
+        connectDnsMs = 0;
+        connectTcpMs = 0;
+        connectTlsMs = 0;
+        return true;
+    }
+
+    close();
+    strlcpy(host, newHost, sizeof(host));
+    port = newPort;
+    tls = newTls;
+    return openConnection();
+}
+
+bool HttpSession::openConnection() {
+    dropConnection();
+    rxLen = rxPos = 0;
+    if (budget && budget->cannotStart(PHASE_DNS)) return false;
+
+    // The lookup itself can't be cut short, only judged afterwards
+    unsigned long start = millis();
+    uint32_t dnsAllowed = budget ? budget->allow(PHASE_DNS) : UINT32_MAX;
+    IPAddress ip;
+    bool resolvedOk;
+    {
+        PhaseTimer timer(PHASE_DNS);
+        resolvedOk = WiFi.hostByName(host, ip);
+    }
+    unsigned long resolved = millis();
+    if (budget && resolved - start > dnsAllowed) {
+        budget->exhaust(PHASE_DNS);
+        resolvedOk = false;
+    }
+    if (!resolvedOk) {
+        LOG_ERROR("HTTP: DNS lookup failed for %s\n", host);
+        return false;
+    }
+
+    if (budget && budget->cannotStart(PHASE_HTTP_CONNECT)) return false;
+    uint32_t connectAllowed = budget ? budget->allow(PHASE_HTTP_CONNECT) : HTTP_IO_TIMEOUT_MS;
+    bool connected;
+    {
+        PhaseTimer timer(PHASE_HTTP_CONNECT);
+        connected = client.connect(ip, port, connectAllowed);
+    }
+    if (!connected) {
+        if (budget && millis() - resolved >= connectAllowed) {
+            budget->exhaust(PHASE_HTTP_CONNECT);
+        }
+        LOG_ERROR("HTTP: connect to %s:%u failed\n", host, port);
+        return false;
+    }
+    client.setNoDelay(true);
+    unsigned long tcpDone = millis();
+
+    if (tls) {
+        if (budget && budget->cannotStart(PHASE_TLS_FULL)) {
+            client.stop();
+            return false;
+        }
+        uint32_t tlsAllowed = budget ? budget->allow(PHASE_TLS_FULL) : HTTP_IO_TIMEOUT_MS;
+        if (!tls->handshake(client, host, tlsAllowed)) {
+            if (budget && millis() - tcpDone >= tlsAllowed) {
+                budget->exhaust(PHASE_TLS_FULL);
+            }
+            client.stop();
+            return false;
+        }
+    }
+
+    connectDnsMs = resolved - start;
+    connectTcpMs = tcpDone - resolved;
+    connectTlsMs = tls ? millis() - tcpDone : 0;
+    connectionReused = false;
+    serverKeepsAlive = true;
+    lastUsedMs = millis();
+    return true;
+}
+
+bool HttpSession::writeRequest(const char* path, const char* body) {
+    char request[HTTP_PATH_MAX + 224];
+    const char* acceptEncoding =
+        acceptGzip && inflater.ready() ? "Accept-Encoding: gzip\r\n" : "";
+    int len;
+    if (body) {
+        len = snprintf(request, sizeof(request),
+                       "POST %s HTTP/1.1\r\n"
+                       "Host: %s\r\n"
+                       "User-Agent: LilyGoWeather/1.3\r\n"
+                       "Accept: application/json\r\n"
+                       "%s"
+                       "Content-Type: application/json\r\n"
+                       "Content-Length: %u\r\n"
+                       "Connection: keep-alive\r\n"
+                       "\r\n",
+                       path, host, acceptEncoding, (unsigned)strlen(body));
+    } else {
+        len = snprintf(request, sizeof(request),
+                       "GET %s HTTP/1.1\r\n"
+                       "Host: %s\r\n"
+                       "User-Agent: LilyGoWeather/1.3\r\n"
+                       "Accept: application/json\r\n"
+                       "%s"
+                       "Connection: keep-alive\r\n"
+                       "\r\n",
+                       path, host, acceptEncoding);
+    }
+    if (len <= 0 || len >= (int)sizeof(request)) return false;
+    if (transportWrite((const uint8_t*)request, len) != (size_t)len) return false;
+    if (!body) return true;
+    size_t bodyLen = strlen(body);
+    return transportWrite((const uint8_t*)body, bodyLen) == bodyLen;
+}
+
+bool HttpSession::sendGet(const char* path) {
+    return queueRequest(path, nullptr);
+}
+
+bool HttpSession::sendPost(const char* path, const char* jsonBody) {
+    return queueRequest(path, jsonBody);
+}
+
+bool HttpSession::queueRequest(const char* path, const char* body) {
+    if (pendingCount >= HTTP_MAX_PIPELINE || strlen(path) >= HTTP_PATH_MAX) return false;
+    strlcpy(pending[pendingCount], path, HTTP_PATH_MAX);
+    pendingBody[pendingCount] = body;
+    pendingCount++;
+
+    // A failed write is retried by readResponse() on a new connection
+    if (!writeRequest(path, body)) {
+        dropConnection();
+    }
+    return true;
+}
+
+// The server dropped the connection before answering everything we
+// pipelined: reconnect and send the unanswered requests again
+bool HttpSession::resendPending() {
+    if (!openConnection()) return false;
+    for (int i = 0; i < pendingCount; i++) {
+        if (!writeRequest(pending[i], pendingBody[i])) return false;
+    }
+    return true;
+}
+
+// Fill rxBuf if it's empty, waiting up to timeoutMs for the transport
+bool HttpSession::waitForData(uint32_t timeoutMs) {
+    unsigned long start = millis();
+    while (rxPos >= rxLen) {
+        int n = transportRead(rxBuf, sizeof(rxBuf));
+        if (n > 0) {
+            rxLen = n;
+            rxPos = 0;
+            break;
+        }
+        if (n < 0 || millis() - start > timeoutMs) {
+            return false;
+        }
+        delay(1);
+    }
+    return true;
+}
+
+// Bytes read (decrypted for TLS), 0 if none yet, -1 once closed
+int HttpSession::transportRead(uint8_t* buf, size_t size) {
+    if (tls) return tls->read(buf, size);
+    if (client.available() > 0) {
+        int n = client.read(buf, size);
+        return n > 0 ? n : 0;
+    }
+    return client.connected() ? 0 : -1;
+}
+
+size_t HttpSession::transportWrite(const uint8_t* buf, size_t len) {
+    if (tls) return tls->write(buf, len);
+    return client.write(buf, len);
+}
+
+// Response bytes that arrived but haven't been read yet
+bool HttpSession::transportBuffered() {
+    if (rxPos < rxLen || client.available() > 0) return true;
+    return tls && tls->pending() > 0;
+}
+
+bool HttpSession::responseStarted() {
+    return pendingCount > 0 && transportBuffered();
+}
+
+void HttpSession::dropConnection() {
+    leaveBodySpan();
+    if (tls) tls->close();
+    client.stop();
+}
+
+// The body span ends with finishResponse(), or with the connection when
+// the caller gives up on a response (not 200) without reading its body
+void HttpSession::leaveBodySpan() {
+    if (!bodySpanOpen) return;
+    memoryLeave(MEM_SPAN_HTTP_BODY);
+    bodySpanOpen = false;
+}
+
+// Reads from here on belong to the given phase and must finish within
+// its share of the budget
+void HttpSession::startIoDeadline(Phase phase) {
+    ioPhase = phase;
+    if (budget) ioDeadlineMs = millis() + budget->allow(phase);
+}
+
+// How long the next read may wait; 0 once the phase's deadline passed
+uint32_t HttpSession::ioWaitMs() {
+    if (!budget) return HTTP_IO_TIMEOUT_MS;
+    long left = (long)(ioDeadlineMs - millis());
+    if (left <= 0) {
+        budget->exhaust(ioPhase);
+        return 0;
+    }
+    return (uint32_t)left < HTTP_IO_TIMEOUT_MS ? (uint32_t)left : HTTP_IO_TIMEOUT_MS;
+}
+
+int HttpSession::readByte() {
+    if (rxPos >= rxLen) {
+        uint32_t waitMs = ioWaitMs();
+        if (waitMs == 0 || !waitForData(waitMs)) {
+            if (budget && (long)(ioDeadlineMs - millis()) <= 0) budget->exhaust(ioPhase);
+            return -1;
+        }
+    }
+    return rxBuf[rxPos++];
+}
+
+// Read one CRLF-terminated line without the terminator; long lines are
+// truncated (the rest is consumed)
+bool HttpSession::readLine(char* line, size_t size) {
+    size_t len = 0;
+    for (;;) {
+        int c = readByte();
+        if (c < 0) return false;
+        if (c == '\n') break;
+        if (c != '\r' && len + 1 < size) line[len++] = (char)c;
+    }
+    line[len] = '\0';
+    return true;
+}
+
+int HttpSession::readResponse() {
+    if (pendingCount == 0) return -1;
+
+    char line[128];
+    bool gotStatus = false;
+    for (int attempt = 0; attempt < 2 && !gotStatus; attempt++) {
+        bool buffered = transportBuffered();
+        if (!buffered && !client.connected()) {
+            if (!resendPending()) return -1;
+        }
+
+        if (budget && budget->cannotStart(PHASE_HTTP_TTFB)) return -1;
+        unsigned long waitStart = millis();
+        int64_t waitStartUs = esp_timer_get_time();
+        startIoDeadline(PHASE_HTTP_TTFB);
+        uint32_t waitMs = ioWaitMs();
+        if (waitMs > 0 && waitForData(waitMs) && readLine(line, sizeof(line))) {
+            lastTimings.ttfbMs = millis() - waitStart;
+            phaseRecord(PHASE_HTTP_TTFB, (uint32_t)(esp_timer_get_time() - waitStartUs));
+            gotStatus = true;
+        } else {
+            // Typically a warm connection the server closed while idle;
+            // no second attempt once the time is gone
+            if (budget && (long)(ioDeadlineMs - millis()) <= 0) {
+                budget->exhaust(PHASE_HTTP_TTFB);
+            }
+            dropConnection();
+            rxLen = rxPos = 0;
+            if (budget && budget->exhausted()) return -1;
+        }
+    }
+    if (!gotStatus) return -1;
+
+    lastTimings.dnsMs = connectDnsMs;
+    lastTimings.connectMs = connectTcpMs;
+    lastTimings.tlsMs = connectTlsMs;
+    lastTimings.tlsResumed = tls && tls->lastResumed();
+    lastTimings.reused = connectionReused;
+    // Later responses on this connection didn't pay for the handshake
+    connectDnsMs = 0;
+    connectTcpMs = 0;
+    connectTlsMs = 0;
+    connectionReused = true;
+
+    // Status line: "HTTP/1.1 200 OK"
+    int status = -1;
+    bool http10 = strncmp(line, "HTTP/1.0", 8) == 0;
+    const char* space = strchr(line, ' ');
+    if (strncmp(line, "HTTP/", 5) != 0 || !space) {
+        dropConnection();
+        return -1;
+    }
+    status = atoi(space + 1);
+
+    // Headers
+    int32_t contentLength = -1;
+    bool chunked = false;
+    bool gzip = false;
+    serverKeepsAlive = !http10;
+    for (;;) {
+        if (!readLine(line, sizeof(line))) {
+            dropConnection();
+            return -1;
+        }
+        if (line[0] == '\0') break;
+
+        char* colon = strchr(line, ':');
+        if (!colon) continue;
+        *colon = '\0';
+        const char* value = colon + 1;
+        while (*value == ' ') value++;
+
+        if (strcasecmp(line, "Content-Length") == 0) {
+            contentLength = atol(value);
+        } else if (strcasecmp(line, "Transfer-Encoding") == 0) {
+            chunked = strcasestr(value, "chunked") != nullptr;
+        } else if (strcasecmp(line, "Content-Encoding") == 0) {
+            gzip = strcasestr(value, "gzip") != nullptr;
+        } else if (strcasecmp(line, "Connection") == 0) {
+            if (strcasestr(value, "close")) serverKeepsAlive = false;
+            if (strcasestr(value, "keep-alive")) serverKeepsAlive = true;
+        }
+    }
+
+    bodyStream.session = this;
+    bodyStream.chunked = chunked;
+    bodyStream.firstChunk = true;
+    bodyStream.remaining = chunked ? 0 : contentLength;
+    bodyStream.done = (!chunked && contentLength == 0) || status == 204 || status == 304;
+    bodyStream.rawDone = bodyStream.done;
+    bodyStream.gzip = gzip && !bodyStream.done;
+    bodyStream.error = false;
+    bodyStream.lookahead = -1;
+    bodyStream.bytesRead = 0;
+    bodyStream.wireBytes = 0;
+    if (bodyStream.gzip) {
+        // Only sent when asked for, and then the inflater is allocated
+        if (!inflater.ready()) {
+            dropConnection();
+            return -1;
+        }
+        inflater.begin(HttpBodyStream::gzipSource, &bodyStream);
+    }
+    // Without a length or chunking the body ends when the server closes
+    if (!chunked && contentLength < 0) serverKeepsAlive = false;
+
+    bodyStartMs = millis();
+    bodyStartUs = esp_timer_get_time();
+    startIoDeadline(PHASE_HTTP_BODY);
+    memoryEnter(MEM_SPAN_HTTP_BODY);
+    bodySpanOpen = true;
+    return status;
+}
+
+bool HttpSession::finishResponse(const char* label) {
+    // Discard whatever the parser didn't consume so the next response
+    // starts at its status line
+    while (bodyStream.read() >= 0) {}
+
+    lastTimings.bodyMs = millis() - bodyStartMs;
+    phaseRecord(PHASE_HTTP_BODY, (uint32_t)(esp_timer_get_time() - bodyStartUs));
+    leaveBodySpan();
+    lastTimings.bodyBytes = bodyStream.bytesRead;
+    lastTimings.wireBytes = bodyStream.wireBytes;
+    lastTimings.gzipped = bodyStream.gzip;
+    lastTimings.bodyFailed = bodyStream.failed();
+    lastUsedMs = millis();
+
+    char tlsPart[32] = "";
+    if (lastTimings.tlsMs) {
+        snprintf(tlsPart, sizeof(tlsPart), ", tls %u ms (%s)", lastTimings.tlsMs,
+                 lastTimings.tlsResumed ? "resumed" : "full");
+    }
+    char gzipPart[32] = "";
+    if (lastTimings.gzipped) {
+        snprintf(gzipPart, sizeof(gzipPart), ", %u gzipped", lastTimings.wireBytes);
+    }
+    // Logged between the two pipelined responses, so it must not block
+    LOG_INFO("HTTP %s: dns %u ms, connect %u ms%s, ttfb %u ms, body %u ms (%u bytes%s)%s\n",
+             label, lastTimings.dnsMs, lastTimings.connectMs, tlsPart, lastTimings.ttfbMs,
+             lastTimings.bodyMs, lastTimings.bodyBytes, gzipPart,
+             lastTimings.reused ? ", reused connection" : "");
+
+    // Oldest request is answered
+    for (int i = 1; i < pendingCount; i++) {
+        strlcpy(pending[i - 1], pending[i], HTTP_PATH_MAX);
+        pendingBody[i - 1] = pendingBody[i];
+    }
+    if (pendingCount > 0) pendingCount--;
+
+    if (bodyStream.failed() || !serverKeepsAlive) {
+        dropConnection();
+        rxLen = rxPos = 0;
+        return false;
+    }
+    return true;
+}
+
+void HttpSession::close() {
+    dropConnection();
+    rxLen = rxPos = 0;
+    pendingCount = 0;
+}
+
+bool HttpSession::isConnected() {
+    return client.connected();
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "Arduino.h"
+#include "WiFi.h"
+#include "request_budget.h"
+#include "tls_channel.h"
+#include "gzip_inflater.h"
+
+// ========================================
+// Keep-alive HTTP/1.1 Fetch Session
+// ========================================
+// One TCP connection that is reused for several requests to the same
+// host. Requests can be pipelined (all written before the first response
+// is read); if the server closes the connection early, the unanswered
+// requests are re-sent on a fresh connection. Response bodies are exposed
+// as a Stream (Content-Length, chunked or read-until-close) so they can
+// be fed straight into deserializeJson().
+//
+// With a RequestBudget attached, DNS, connect, time to first byte and the
+// body read each get their share of it instead of HTTP_IO_TIMEOUT_MS, and
+// a request that runs out fails as a read error.
+//
+// With a TlsChannel the connection is HTTPS; the channel keeps its
+// contexts and session between connections (see tls_channel.h).
+//
+// With gzip accepted, a gzip-encoded body is inflated as the stream is
+// read (see gzip_inflater.h); readers always see the decoded document.
+
+#define HTTP_MAX_PIPELINE     2      // Requests in flight on one connection
+#define HTTP_PATH_MAX         320
+#define HTTP_RX_BUFFER        512
+#define HTTP_IO_TIMEOUT_MS    10000  // Per read/connect wait
+#define HTTP_KEEPALIVE_IDLE_MS 60000 // Don't expect a server to keep idle
+                                     // connections longer than this
+
+// Per-request phase timings (milliseconds)
+struct HttpTimings {
+    uint32_t dnsMs;       // 0 when the connection was reused
+    uint32_t connectMs;   // 0 when the connection was reused
+    uint32_t tlsMs;       // Handshake; 0 when reused or plain HTTP
+    bool tlsResumed;
+    uint32_t ttfbMs;      // Request written -> first response byte
+    uint32_t bodyMs;      // First body byte requested -> body finished
+    uint32_t bodyBytes;   // Decoded
+    uint32_t wireBytes;   // As received; less than bodyBytes when gzipped
+    bool gzipped;
+    bool reused;          // Connection was already open (warm)
+    bool bodyFailed;      // Body cut short, or failed its gzip length/CRC check
+};
+
+class HttpSession;
+
+// Body of the current response
+class HttpBodyStream : public Stream {
+public:
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t) override { return 0; }
+    void flush() override {}
+
+    bool finished() const { return done; }
+    bool failed() const { return error; }
+
+private:
+    friend class HttpSession;
+    bool nextChunk();
+    int readRaw();
+    static size_t gzipSource(void* ctx, uint8_t* buf, size_t size);
+
+    HttpSession* session = nullptr;
+    int32_t remaining = -1;      // Bytes left in body or current chunk, -1 = until close
+    bool chunked = false;
+    bool gzip = false;           // Content-Encoding: gzip, inflated on read
+    bool firstChunk = true;
+    bool rawDone = true;         // Transfer encoding finished
+    bool done = true;            // No more decoded bytes
+    bool error = false;
+    int lookahead = -1;
+    uint32_t bytesRead = 0;
+    uint32_t wireBytes = 0;
+};
+
+class HttpSession {
+public:
+    // Open (or keep) a connection to host:port, over tls if given. An
+    // existing connection to the same host is reused when it is still up.
+    bool connect(const char* host, uint16_t port, TlsChannel* tls = nullptr);
+
+    // Queue a GET request; it is written to the socket immediately
+    bool sendGet(const char* path);
+
+    // Queue a POST with a JSON body. The body is not copied: it must stay
+    // valid until its response has been read, as it may be re-sent.
+    bool sendPost(const char* path, const char* jsonBody);
+
+    // Read the status line and headers of the oldest pending request.
+    // Returns the HTTP status code, or a negative value on failure.
+    int readResponse();
+
+    // True once bytes of the oldest pending response have arrived.
+    // Doesn't block; for racing requests on two sessions before
+    // committing to one readResponse().
+    bool responseStarted();
+
+    // Body of the response returned by the last readResponse()
+    Stream& body() { return bodyStream; }
+
+    // Discard any unread body and log the timings; returns false if the
+    // connection can't carry the next response, because the server closes
+    // it or the body failed (timings().bodyFailed)
+    bool finishResponse(const char* label);
+
+    void close();
+    bool isConnected();
+
+    const HttpTimings& timings() const { return lastTimings; }
+
+    // Deadlines for every following request; nullptr for plain timeouts
+    void setBudget(RequestBudget* newBudget) { budget = newBudget; }
+
+    // Ask for gzip-encoded bodies in following requests. Only sent once
+    // the inflater's window could be allocated.
+    void setAcceptGzip(bool accept) { acceptGzip = accept; }
+
+private:
+    friend class HttpBodyStream;
+
+    bool openConnection();
+    bool resendPending();
+    bool queueRequest(const char* path, const char* body);
+    bool writeRequest(const char* path, const char* body);
+    int readByte();
+    bool waitForData(uint32_t timeoutMs);
+    int transportRead(uint8_t* buf, size_t size);
+    size_t transportWrite(const uint8_t* buf, size_t len);
+    bool transportBuffered();
+    void dropConnection();
+    void leaveBodySpan();
+    bool readLine(char* line, size_t size);
+    void startIoDeadline(Phase phase);
+    uint32_t ioWaitMs();
+
+    WiFiClient client;
+    TlsChannel* tls = nullptr;
+    char host[64] = "";
+    uint16_t port = 80;
+    bool serverKeepsAlive = true;
+    unsigned long lastUsedMs = 0;
+
+    // Requests written but not yet answered, oldest first
+    char pending[HTTP_MAX_PIPELINE][HTTP_PATH_MAX];
+    const char* pendingBody[HTTP_MAX_PIPELINE];   // nullptr for GET
+    int pendingCount = 0;
+
+    uint8_t rxBuf[HTTP_RX_BUFFER];
+    size_t rxLen = 0;
+    size_t rxPos = 0;
+
+    HttpBodyStream bodyStream;
+    GzipInflater inflater;
+    bool acceptGzip = false;
+    HttpTimings lastTimings = {};
+    uint32_t connectDnsMs = 0;
+    uint32_t connectTcpMs = 0;
+    uint32_t connectTlsMs = 0;
+    bool connectionReused = false;
+    unsigned long bodyStartMs = 0;
+    int64_t bodyStartUs = 0;
+    bool bodySpanOpen = false;           // MEM_SPAN_HTTP_BODY entered, not yet left
+
+    RequestBudget* budget = nullptr;
+    Phase ioPhase = PHASE_HTTP_TTFB;     // Phase the current reads belong to
+    unsigned long ioDeadlineMs = 0;      // millis() it must finish by
+};
@@ -0,0 +1,101 @@
+#include "json_arena.h"
+
+#include "esp_heap_caps.h"
+
+// Every block starts with its size, and stays 8-byte aligned for the
+// doubles and pointers ArduinoJson stores
+#define ARENA_ALIGN   8
+#define ARENA_HEADER  ARENA_ALIGN
+
+static size_t alignUp(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+bool JsonArena::begin(size_t bytes) {
+    if (base) return true;
+    base = (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM);
+    if (!base) base = (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+    if (!base) {
+        Serial.printf("✗ JSON arena: %u bytes unavailable, using the heap\n", (unsigned)bytes);
+        return false;
+    }
+    size = bytes;
+    reset();
+    return true;
+}
+
+void JsonArena::reset() {
+    top = 0;
+    last = SIZE_MAX;
+}
+
+static size_t& blockSize(uint8_t* block) {
+    return *(size_t*)(block - ARENA_HEADER);
+}
+
+void* JsonArena::allocate(size_t bytes) {
+    if (!base) return malloc(bytes);
+
+    size_t needed = ARENA_HEADER + alignUp(bytes);
+    if (needed > size - top) {
+        failures++;
+        return nullptr;
+    }
+    uint8_t* block = base + top + ARENA_HEADER;
+    blockSize(block) = bytes;
+    last = top;
+    top += needed;
+    if (top > peak) peak = top;
+    return block;
+}
+
+void JsonArena::deallocate(void* ptr) {
+    if (!base) {
+        free(ptr);
+        return;
+    }
+    // Only the newest block gives its space back; the rest waits for reset()
+    if (ptr && (uint8_t*)ptr == base + last + ARENA_HEADER) {
+        top = last;
+        last = SIZE_MAX;
+    }
+}
+
+void* JsonArena::reallocate(void* ptr, size_t bytes) {
+    if (!base) return realloc(ptr, bytes);
+    if (!ptr) return allocate(bytes);
+
+    uint8_t* block = (uint8_t*)ptr;
+    if (block == base + last + ARENA_HEADER) {
+        // Newest block: grow or shrink in place
+        size_t end = last + ARENA_HEADER + alignUp(bytes);
+        if (end > size) {
+            failures++;
+            return nullptr;
+        }
+        blockSize(block) = bytes;
+        top = end;
+        if (top > peak) peak = top;
+        return block;
+    }
+
+    size_t oldBytes = blockSize(block);
+    if (bytes <= oldBytes) {
+        blockSize(block) = bytes;   // The tail is lost until reset()
+        return block;
+    }
+    void* moved = allocate(bytes);
+    if (moved) memcpy(moved, block, oldBytes);
+    return moved;
+}
+
+void JsonArena::logUsage(const char* label) {
+    if (!base) return;
+    Serial.printf("JSON arena (%s): %u bytes used, high water %u of %u\n", label,
+                  (unsigned)top, (unsigned)peak, (unsigned)size);
+    if (failures) {
+        Serial.printf("✗ JSON arena: %u allocations didn't fit, raise JSON_ARENA_SIZE\n",
+                      (unsigned)failures);
+        failures = 0;
+    }
+}
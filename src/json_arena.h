@@ -0,0 +1,54 @@
+#pragma once
+
+#include "ArduinoJson.h"
+
+// ========================================
+// Bump Arena for ArduinoJson Documents
+// ========================================
+// An ArduinoJson Allocator that hands out memory from one block,
+// allocated once at startup (PSRAM when the board has it). Allocation is
+// a pointer bump, deallocation is free, and reset() drops everything at
+// once. The documents and filters of a weather fetch never touch the
+// general heap, so their growth can't fragment it between the String
+// and LVGL allocations.
+//
+// Only the most recent allocation can grow or shrink in place (the
+// document's pools and its string buffer grow this way); anything else
+// is moved. The high-water mark shows how big the arena needs to be.
+// When it's full, allocation fails and deserializeJson() reports
+// NoMemory; raise JSON_ARENA_SIZE.
+
+#ifndef JSON_ARENA_SIZE
+#define JSON_ARENA_SIZE  (32 * 1024)
+#endif
+
+class JsonArena : public ArduinoJson::Allocator {
+public:
+    // Allocate the block; if that fails, allocations go to the heap
+    bool begin(size_t size = JSON_ARENA_SIZE);
+
+    // Forget every allocation. No document using the arena may outlive it.
+    void reset();
+
+    size_t used() const { return top; }
+    size_t highWater() const { return peak; }
+
+    // Start the high-water mark over from what's in use now
+    void resetHighWater() { peak = top; }
+    size_t capacity() const { return size; }
+
+    // Log use and high-water mark, and any failed allocations
+    void logUsage(const char* label);
+
+    void* allocate(size_t bytes) override;
+    void deallocate(void* ptr) override;
+    void* reallocate(void* ptr, size_t bytes) override;
+
+private:
+    uint8_t* base = nullptr;
+    size_t size = 0;
+    size_t top = 0;
+    size_t last = SIZE_MAX;    // Offset of the newest block's header
+    size_t peak = 0;
+    uint32_t failures = 0;
+};
@@ -0,0 +1,201 @@
+#include "location_cache.h"
+
+#include "WiFi.h"
+#include <Preferences.h>
+#include "esp_rom_crc.h"
+#include "phase_timer.h"
+
+#define LOCATION_CACHE_MAGIC   0x4C4F4343  // "LOCC"
+#define LOCATION_CACHE_VERSION 1
+#define LOCATION_SCAN_MAX      64          // Scan results considered
+
+struct LocationCacheEntry {
+    LocationFingerprint fingerprint;
+    float latitude;
+    float longitude;
+    float accuracy;
+    uint32_t lastUsed;  // 0 = empty slot
+};
+
+// NVS layout; crc covers every byte before it
+struct LocationCacheRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    uint32_t useCounter;
+    LocationCacheEntry entries[LOCATION_CACHE_ENTRIES];
+    uint32_t crc;
+};
+
+static uint32_t recordCrc(const LocationCacheRecord& rec) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&rec, offsetof(LocationCacheRecord, crc));
+}
+
+// Load the cache, or start an empty one if there is none (or it's corrupt)
+static void loadCache(LocationCacheRecord& rec) {
+    Preferences prefs;
+    bool ok = false;
+    if (prefs.begin(LOCATION_CACHE_NVS_NAMESPACE, true)) {
+        ok = prefs.getBytesLength(LOCATION_CACHE_NVS_KEY) == sizeof(rec) &&
+             prefs.getBytes(LOCATION_CACHE_NVS_KEY, &rec, sizeof(rec)) == sizeof(rec);
+        prefs.end();
+    }
+    ok = ok && rec.magic == LOCATION_CACHE_MAGIC && rec.version == LOCATION_CACHE_VERSION &&
+         rec.size == sizeof(rec) && rec.crc == recordCrc(rec);
+    if (!ok) {
+        memset(&rec, 0, sizeof(rec));
+        rec.magic = LOCATION_CACHE_MAGIC;
+        rec.version = LOCATION_CACHE_VERSION;
+        rec.size = sizeof(rec);
+    }
+}
+
+static void saveCache(LocationCacheRecord& rec) {
+    rec.crc = recordCrc(rec);
+    Preferences prefs;
+    if (!prefs.begin(LOCATION_CACHE_NVS_NAMESPACE, false)) {
+        Serial.println("Location cache: NVS unavailable, not saved");
+        return;
+    }
+    prefs.putBytes(LOCATION_CACHE_NVS_KEY, &rec, sizeof(rec));
+    prefs.end();
+}
+
+// Index of the most similar entry, or -1 if none reaches the threshold
+static int findMatch(const LocationCacheRecord& rec, const LocationFingerprint& fingerprint,
+                     float& bestSimilarity) {
+    int best = -1;
+    bestSimilarity = 0;
+    for (int i = 0; i < LOCATION_CACHE_ENTRIES; i++) {
+        if (rec.entries[i].lastUsed == 0) continue;
+        float similarity = fingerprintSimilarity(fingerprint, rec.entries[i].fingerprint);
+        if (similarity >= LOCATION_FP_MATCH_THRESHOLD && similarity > bestSimilarity) {
+            best = i;
+            bestSimilarity = similarity;
+        }
+    }
+    return best;
+}
+
+bool scanLocationFingerprint(LocationFingerprint& fingerprint) {
+    fingerprint.count = 0;
+    unsigned long start = millis();
+    int found;
+    {
+        PhaseTimer timer(PHASE_WIFI_SCAN);
+        found = WiFi.scanNetworks();
+    }
+    if (found <= 0) {
+        WiFi.scanDelete();
+        return false;
+    }
+    if (found > LOCATION_SCAN_MAX) found = LOCATION_SCAN_MAX;
+
+    int32_t rssi[LOCATION_SCAN_MAX];
+    uint32_t hash[LOCATION_SCAN_MAX];
+    for (int i = 0; i < found; i++) {
+        rssi[i] = WiFi.RSSI(i);
+        hash[i] = esp_rom_crc32_le(0, WiFi.BSSID(i), 6);
+    }
+    WiFi.scanDelete();
+
+    // Keep the strongest APs: partial selection sort by RSSI
+    int keep = found < LOCATION_FP_MAX_APS ? found : LOCATION_FP_MAX_APS;
+    for (int i = 0; i < keep; i++) {
+        int strongest = i;
+        for (int j = i + 1; j < found; j++) {
+            if (rssi[j] > rssi[strongest]) strongest = j;
+        }
+        int32_t r = rssi[i]; rssi[i] = rssi[strongest]; rssi[strongest] = r;
+        uint32_t h = hash[i]; hash[i] = hash[strongest]; hash[strongest] = h;
+    }
+
+    // Sorted and de-duplicated, so similarity is a linear merge
+    for (int i = 1; i < keep; i++) {
+        uint32_t h = hash[i];
+        int j = i - 1;
+        while (j >= 0 && hash[j] > h) {
+            hash[j + 1] = hash[j];
+            j--;
+        }
+        hash[j + 1] = h;
+    }
+    for (int i = 0; i < keep; i++) {
+        if (fingerprint.count == 0 || fingerprint.bssidHash[fingerprint.count - 1] != hash[i]) {
+            fingerprint.bssidHash[fingerprint.count++] = hash[i];
+        }
+    }
+
+    Serial.printf("Location fingerprint: %d of %d APs in %lu ms\n",
+                  fingerprint.count, found, millis() - start);
+    return fingerprint.count >= LOCATION_FP_MIN_APS;
+}
+
+float fingerprintSimilarity(const LocationFingerprint& a, const LocationFingerprint& b) {
+    int shared = 0;
+    int i = 0, j = 0;
+    while (i < a.count && j < b.count) {
+        if (a.bssidHash[i] == b.bssidHash[j]) {
+            shared++;
+            i++;
+            j++;
+        } else if (a.bssidHash[i] < b.bssidHash[j]) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    int combined = a.count + b.count - shared;
+    return combined > 0 ? (float)shared / combined : 0.0f;
+}
+
+bool lookupCachedLocation(const LocationFingerprint& fingerprint,
+                          float& latitude, float& longitude, float& accuracy) {
+    LocationCacheRecord rec;
+    loadCache(rec);
+
+    float similarity;
+    int index = findMatch(rec, fingerprint, similarity);
+    if (index < 0) {
+        Serial.println("Location cache: miss");
+        return false;
+    }
+
+    LocationCacheEntry& entry = rec.entries[index];
+    latitude = entry.latitude;
+    longitude = entry.longitude;
+    accuracy = entry.accuracy;
+    Serial.printf("Location cache: hit (entry %d, similarity %.2f)\n", index, similarity);
+
+    // Only write flash when the LRU order actually changes
+    if (entry.lastUsed != rec.useCounter) {
+        entry.lastUsed = ++rec.useCounter;
+        saveCache(rec);
+    }
+    return true;
+}
+
+void storeCachedLocation(const LocationFingerprint& fingerprint,
+                         float latitude, float longitude, float accuracy) {
+    LocationCacheRecord rec;
+    loadCache(rec);
+
+    // Same environment: replace it. Otherwise an empty or the LRU slot.
+    float similarity;
+    int index = findMatch(rec, fingerprint, similarity);
+    if (index < 0) {
+        index = 0;
+        for (int i = 1; i < LOCATION_CACHE_ENTRIES; i++) {
+            if (rec.entries[i].lastUsed < rec.entries[index].lastUsed) index = i;
+        }
+    }
+
+    LocationCacheEntry& entry = rec.entries[index];
+    entry.fingerprint = fingerprint;
+    entry.latitude = latitude;
+    entry.longitude = longitude;
+    entry.accuracy = accuracy;
+    entry.lastUsed = ++rec.useCounter;
+    saveCache(rec);
+    Serial.printf("Location cache: stored entry %d\n", index);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+
+// ========================================
+// WiFi Fingerprint Location Cache
+// ========================================
+// Remembers where the device was for each WiFi environment it has seen.
+// A fingerprint is the set of the strongest visible BSSIDs (hashed); a
+// new scan that is similar enough (Jaccard index of the two sets) to a
+// cached fingerprint resolves to that entry's coordinates, so only new
+// environments need a Google Geolocation API call. Entries live in NVS
+// with least-recently-used eviction.
+
+#define LOCATION_FP_MAX_APS         12    // Strongest BSSIDs kept per fingerprint
+#define LOCATION_FP_MIN_APS         2     // Fewer than this is too ambiguous to cache
+#define LOCATION_CACHE_ENTRIES      8
+#ifndef LOCATION_FP_MATCH_THRESHOLD
+#define LOCATION_FP_MATCH_THRESHOLD 0.5f  // Shared / combined BSSIDs
+#endif
+#define LOCATION_CACHE_NVS_NAMESPACE "location"
+#define LOCATION_CACHE_NVS_KEY       "cache"
+
+struct LocationFingerprint {
+    uint32_t bssidHash[LOCATION_FP_MAX_APS];  // Sorted ascending
+    uint8_t count;
+};
+
+// Scan for access points and build a fingerprint; false if too few
+// networks are visible
+bool scanLocationFingerprint(LocationFingerprint& fingerprint);
+
+// Jaccard similarity (0..1) of two fingerprints
+float fingerprintSimilarity(const LocationFingerprint& a, const LocationFingerprint& b);
+
+// Best cached entry at or above LOCATION_FP_MATCH_THRESHOLD; false on a miss
+bool lookupCachedLocation(const LocationFingerprint& fingerprint,
+                          float& latitude, float& longitude, float& accuracy);
+
+// Remember an API result for this fingerprint, evicting the least
+// recently used entry when the cache is full
+void storeCachedLocation(const LocationFingerprint& fingerprint,
+                         float latitude, float longitude, float accuracy);
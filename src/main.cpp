@@ -1,12 +1,37 @@
 #include "Arduino.h"
 #include "WiFi.h"
-#include "HTTPClient.h"
 #include "ArduinoJson.h"
 #include "lvgl.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_ops.h"
 #include "esp_lcd_panel_vendor.h"
 #include "pin_config.h"
+#include "forecast_aggregator.h"
+#include "weather_types.h"
+#include "snapshot_store.h"
+#include "snapshot_channel.h"
+#include "http_session.h"
+#include "posix_tz.h"
+#include "zones.h"
+#include "power.h"
+#include "duty_cycle.h"
+#include "wifi_fast_connect.h"
+#include "location_cache.h"
+#include "text_format.h"
+#include "phase_timer.h"
+#include "memory_monitor.h"
+#include "weather_ui.h"
+#include "request_budget.h"
+#include "refresh_scheduler.h"
+#include "tls_channel.h"
+#include "ca_certs.h"
+#include "json_arena.h"
+#include "deferred_log.h"
+#include "weather_provider.h"
+#include "owm_provider.h"
+#include "open_meteo_provider.h"
+#include "hedged_fetch.h"
+#include <atomic>
 #include <time.h>
 #include <WifiLocation.h>
 
@@ -18,50 +43,165 @@
 #define UNITS "imperial"
 #define UPDATE_INTERVAL_MS (30 * 60 * 1000)  // 30 minutes
 
+// API endpoints. Override with -D in platformio.ini to point the firmware
+// at tools/mock_api_server.py, e.g.
+//   -D OPENWEATHER_HOST=\"192.168.1.20\" -D OPENWEATHER_PORT=8080 -D OPENWEATHER_TLS=0
+#ifndef OPENWEATHER_HOST
+#define OPENWEATHER_HOST "api.openweathermap.org"
+#endif
+#ifndef OPENWEATHER_TLS
+#define OPENWEATHER_TLS 1    // HTTPS, verified against ca_certs.h
+#endif
+#ifndef OPENWEATHER_GZIP
+#define OPENWEATHER_GZIP 1   // Ask for gzip bodies, inflated while parsing
+#endif
+#ifndef OPENWEATHER_PORT
+#if OPENWEATHER_TLS
+#define OPENWEATHER_PORT 443
+#else
+#define OPENWEATHER_PORT 80
+#endif
+#endif
+#ifndef OPEN_METEO_HOST
+#define OPEN_METEO_HOST "api.open-meteo.com"
+#endif
+#ifndef OPEN_METEO_TLS
+#define OPEN_METEO_TLS 1
+#endif
+#ifndef OPEN_METEO_PORT
+#if OPEN_METEO_TLS
+#define OPEN_METEO_PORT 443
+#else
+#define OPEN_METEO_PORT 80
+#endif
+#endif
+
+// Where the forecast comes from: WEATHER_PROVIDER_OWM or
+// WEATHER_PROVIDER_OPEN_METEO (see weather_provider.h)
+#ifndef WEATHER_PROVIDER
+#define WEATHER_PROVIDER WEATHER_PROVIDER_OWM
+#endif
+
+// 1: when the provider is slow to answer, ask the other one too and use
+// whichever delivers first (see hedged_fetch.h)
+#ifndef WEATHER_HEDGE
+#define WEATHER_HEDGE 0
+#endif
+
+// >0: after the startup refresh, fetch from every provider this many
+// times and print a comparison (bytes, parse time, memory). Meant for
+// the mock API; these calls bypass the daily call budget.
+#ifndef PROVIDER_BENCHMARK_RUNS
+#define PROVIDER_BENCHMARK_RUNS 0
+#endif
+// Defining GEOLOCATION_API_HOST replaces the WifiLocation library (which
+// only talks HTTPS to Google) with a plain-HTTP request to that host
+#ifdef GEOLOCATION_API_HOST
+#ifndef GEOLOCATION_API_PORT
+#define GEOLOCATION_API_PORT 80
+#endif
+#ifndef GEOLOCATION_API_PATH
+#define GEOLOCATION_API_PATH "/geolocation/v1/geolocate?key="
+#endif
+#define GEOLOCATION_MAX_APS 12
+#endif
+
+// 1: deep-sleep between refreshes instead of idling (see duty_cycle.h)
+#ifndef DEEP_SLEEP_MODE
+#define DEEP_SLEEP_MODE 0
+#endif
+
+// Task layout: networking on core 0 (alongside the WiFi stack),
+// LVGL rendering on core 1 so the UI never waits on the network
+#define NETWORK_TASK_CORE 0
+#define NETWORK_TASK_STACK 16384
+#define NETWORK_TASK_PRIORITY 1
+#define UI_TASK_CORE 1
+#define UI_TASK_STACK 8192
+#define UI_TASK_PRIORITY 2
+#define UI_STALE_CHECK_MS (60 * 1000)        // Re-evaluate stale marker, log CPU stats
+
 // Display handles
 esp_lcd_panel_io_handle_t io_handle = NULL;
 esp_lcd_panel_handle_t panel_handle = NULL;
 static lv_disp_draw_buf_t disp_buf;
 static lv_disp_drv_t disp_drv;
 static lv_color_t *lv_disp_buf;
+static lv_color_t *lv_disp_buf2;
 static bool is_initialized_lvgl = false;
 
-// Weather data
-struct WeatherDay {
-    String date;
-    String day_name;
-    String description;
-    int temp_high;
-    int temp_low;
-    int humidity;
-};
+// Woke from a duty-cycle deep sleep with valid state in RTC memory
+static bool warmWake = false;
 
-WeatherDay forecast[3];
-int currentTemp = 0;  // Current temperature for Day 0
-String currentCondition = "";  // Current weather condition for Day 0
-unsigned long lastUpdate = 0;
-bool weatherDataValid = false;
-long timezoneOffset = 0;  // Timezone offset in seconds from UTC (from API)
-
-// Location tracking for WiFi triangulation
-struct Location {
-    float latitude;
-    float longitude;
-    String city;
-    unsigned long lastLocationCheck;
-    bool isValid;
-};
+// Flush statistics for render timing
+static volatile uint32_t flushCount = 0;
+static volatile uint32_t flushPixels = 0;
+static volatile int64_t flushStartUs = 0;
+
+// Set by the BOOT2 button ISR; the UI task prints the phase and memory
+// reports
+static volatile bool phaseReportRequested = false;
+
+// Weather data, handed from the network task to the UI task
+SnapshotChannel<WeatherSnapshot> weatherChannel;
+bool weatherShown = false;       // UI task: a forecast is on screen
+
+// Status message for the UI task to show (string literals only)
+std::atomic<const char*> pendingStatus(nullptr);
+
+// Completed UI task iterations, so another task can wait for the UI to
+// pick up what it just posted
+std::atomic<uint32_t> uiPasses(0);
+
+TaskHandle_t networkTaskHandle = NULL;
+TaskHandle_t uiTaskHandle = NULL;
+
+// Keep-alive connection to the weather API (network task only)
+HttpSession weatherSession;
+
+// Second connection for hedged fetches, to the other provider (network task only)
+HttpSession hedgeSession;
+
+// TLS contexts and saved session for the weather API (network task only).
+// The provider in use gets the one kept over deep sleep; the other
+// provider (hedge target, benchmark) has its own contexts.
+TlsChannel weatherTls(WEATHER_CA_PEM);
+TlsChannel hedgeTls(WEATHER_CA_PEM, false);
+
+static TlsChannel* providerTls(int provider) {
+    return provider == WEATHER_PROVIDER ? &weatherTls : &hedgeTls;
+}
+
+// Memory for the weather fetch's JSON documents (network task only)
+JsonArena jsonArena;
+
+// Forecast backends (network task only); weatherProvider is the one in
+// use, hedgeProvider the other
+OwmProvider owmProvider(OPENWEATHER_HOST, OPENWEATHER_PORT,
+                        OPENWEATHER_TLS ? providerTls(WEATHER_PROVIDER_OWM) : nullptr,
+                        jsonArena, OPENWEATHER_API_KEY, UNITS);
+OpenMeteoProvider openMeteoProvider(OPEN_METEO_HOST, OPEN_METEO_PORT,
+                                    OPEN_METEO_TLS ? providerTls(WEATHER_PROVIDER_OPEN_METEO)
+                                                   : nullptr,
+                                    jsonArena, UNITS);
+#if WEATHER_PROVIDER == WEATHER_PROVIDER_OPEN_METEO
+WeatherProvider& weatherProvider = openMeteoProvider;
+WeatherProvider& hedgeProvider = owmProvider;
+#else
+WeatherProvider& weatherProvider = owmProvider;
+WeatherProvider& hedgeProvider = openMeteoProvider;
+#endif
+
+// Time budget of the current refresh cycle (network task only)
+RequestBudget refreshBudget;
 
 Location currentLocation = {0.0, 0.0, "", 0, false};
+Location restoredLocation = {0.0, 0.0, "", 0, false};  // From the boot snapshot
 const float LOCATION_CHANGE_THRESHOLD_KM = 5.0; // Only update weather if moved >5km
 
-// LVGL UI objects
-lv_obj_t *screen;
-lv_obj_t *title_label;
-lv_obj_t *day_labels[3];
-lv_obj_t *temp_labels[3];
-lv_obj_t *desc_labels[3];
-lv_obj_t *update_label;
+// DST rules for the local zone (network task only)
+PosixTz localZone;
+bool localZoneValid = false;
 
 // LCD commands
 typedef struct {
@@ -88,12 +228,24 @@ lcd_cmd_t lcd_st7789v[] = {
 };
 
 // Function declarations
-void initDisplay();
+void initDisplay(bool panelKeptFrame);
 bool connectToWiFi();
-bool fetchWeatherData();
-void createUI();
-void updateWeatherDisplay();
-String getDayName(const String& dateStr);
+bool fetchWeatherData(WeatherSnapshot& weather);
+void renderWeatherDisplay(const WeatherSnapshot& weather);
+void postStatus(const char* message);
+void publishWeather();
+void waitForUi(uint32_t timeoutMs);
+
+// Tasks
+void networkTask(void* param);
+void uiTask(void* param);
+void onReportButton();
+bool startNetwork();
+void refreshWeather();
+bool fetchAndPublish();
+#if PROVIDER_BENCHMARK_RUNS
+void runProviderBenchmark();
+#endif
 static bool lvgl_flush_ready(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx);
 static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map);
 
@@ -102,14 +254,32 @@ void validateAPIKeys();
 bool getLocationFromWiFi();
 float calculateDistance(float lat1, float lon1, float lat2, float lon2);
 bool locationChanged(float newLat, float newLon);
+bool resolveTimezone();
+#ifdef GEOLOCATION_API_HOST
+bool geolocateOverHttp(location_t& loc);
+#endif
 
 void setup() {
     Serial.begin(115200);
-    delay(1000);
+    logBegin();
+
+#if DEEP_SLEEP_MODE
+    // Timer wake: forecast, location and zone come from RTC memory and
+    // the panel is still showing the last frame
+    warmWake = dutyCycleRestore(weatherChannel.writeSlot(), restoredLocation,
+                                localZone, localZoneValid);
+    if (!warmWake) {
+        dutyCycleReleaseDisplay();
+    }
+#endif
+
+    if (!warmWake) {
+        delay(1000);
+    }
 
     Serial.println("========================================");
     Serial.println("LilyGo Weather Station v1.3.0");
-    Serial.println("With WiFi Triangulation");
+    Serial.println(warmWake ? "Wake from deep sleep" : "With WiFi Triangulation");
     Serial.println("========================================\n");
 
     // Validate API keys first (will halt if not configured)
@@ -118,125 +288,383 @@ void setup() {
     // Power on display
     pinMode(PIN_POWER_ON, OUTPUT);
     digitalWrite(PIN_POWER_ON, HIGH);
-    delay(100);
+    if (!warmWake) {
+        delay(100);
+    }
 
     // Initialize display and LVGL
-    initDisplay();
+    initDisplay(warmWake);
+#if DEEP_SLEEP_MODE
+    if (warmWake) {
+        // Drive the latched pins to the levels they are held at, then let go
+        pinMode(PIN_LCD_BL, OUTPUT);
+        digitalWrite(PIN_LCD_BL, DEEP_SLEEP_KEEP_BACKLIGHT ? HIGH : LOW);
+        dutyCycleReleaseDisplay();
+    }
+#endif
 
     // Create UI
     createUI();
 
-    lv_label_set_text(title_label, "Connecting WiFi...");
-    lv_timer_handler();
-    
-    // Connect to WiFi
-    if (connectToWiFi()) {
-        Serial.println("WiFi connected!");
-
-        // Get location via WiFi triangulation
-        lv_label_set_text(title_label, "Finding Location...");
+    // Draw the last good forecast before touching the network
+    // (after a deep-sleep wake these are the pixels the panel already holds)
+    WeatherSnapshot& restored = weatherChannel.writeSlot();
+    if (warmWake || loadWeatherSnapshot(restored, restoredLocation)) {
+        Serial.printf("✓ Restored forecast %s (fetched at %ld)\n",
+                      warmWake ? "from RTC memory" : "snapshot", (long)restored.fetchedAt);
+        weatherChannel.publish();
+        weatherChannel.acquire();
+        renderWeatherDisplay(weatherChannel.current());
+        weatherShown = true;
+        Serial.printf("Restored frame on screen %lu ms after boot\n", millis());
+    } else {
         lv_timer_handler();
-        Serial.println("\n--- Location Detection ---");
+    }
+
+    // Turn on backlight
+    pinMode(PIN_LCD_BL, OUTPUT);
+    digitalWrite(PIN_LCD_BL, HIGH);
+
+    // Both tasks hold a power lock only while they are doing work
+    powerInit();
+
+    // Button 2 (or 'p' on Serial) prints the phase timing and memory reports
+    pinMode(PIN_BUTTON_2, INPUT_PULLUP);
+    attachInterrupt(PIN_BUTTON_2, onReportButton, FALLING);
+
+    // From here on LVGL belongs to the UI task and WiFi/HTTP to the
+    // network task; they only share weatherChannel and pendingStatus
+    xTaskCreatePinnedToCore(uiTask, "ui", UI_TASK_STACK, NULL,
+                            UI_TASK_PRIORITY, &uiTaskHandle, UI_TASK_CORE);
+    xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, NULL,
+                            NETWORK_TASK_PRIORITY, &networkTaskHandle, NETWORK_TASK_CORE);
+    memoryWatchTask(uiTaskHandle);
+    memoryWatchTask(networkTaskHandle);
+}
+
+void loop() {
+    // All work happens in the pinned tasks
+    vTaskDelete(NULL);
+}
+
+// ========================================
+// Network Task (core 0)
+// ========================================
+void networkTask(void* param) {
+    weatherSession.setBudget(&refreshBudget);
+    weatherSession.setAcceptGzip(OPENWEATHER_GZIP);
+    jsonArena.begin();
+    schedulerInit();
+#if WEATHER_HEDGE
+    hedgeSession.setBudget(&refreshBudget);
+    hedgeSession.setAcceptGzip(OPENWEATHER_GZIP);
+    hedgeInit();
+#endif
+    bool networkReady = false;   // WiFi, location, clock and zone set up
+
+    for (;;) {
+        // Sleep until the next refresh or retry is due rather than polling
+        uint32_t waitMs = schedulerMsUntilRefresh();
+        if (waitMs > 0) {
+#if DEEP_SLEEP_MODE
+            // Let the UI task draw the result (or the error) first. The
+            // panel keeps showing it while we sleep.
+            waitForUi(DEEP_SLEEP_RENDER_WAIT_MS);
+            dutyCycleSleep((waitMs + 999) / 1000);
+#endif
+            vTaskDelay(pdMS_TO_TICKS(waitMs));
+            continue;
+        }
 
-        if (getLocationFromWiFi()) {
-            Serial.println("✓ Location acquired successfully");
-            Serial.printf("Coordinates: %.6f, %.6f\n",
-                         currentLocation.latitude, currentLocation.longitude);
+        PowerLockScope busy(POWER_LOCK_NETWORK);
+        if (!networkReady) {
+            // Until the first cycle gets through, every retry starts over
+            networkReady = startNetwork();
+            if (networkReady) {
+                if (!warmWake) {
+                    postStatus("Fetching Weather...");
+                }
+                Serial.println("\n--- Weather Data ---");
+                if (fetchAndPublish()) {
+                    Serial.println("✓ Weather data loaded successfully\n");
+                } else {
+                    postStatus("Weather Fetch Failed");
+                    Serial.println("✗ Weather fetch failed\n");
+                }
+            }
+            weatherTls.logCycle(refreshBudget.spentMs());
+            hedgeTls.logCycle(refreshBudget.spentMs());
+            refreshBudget.finish("Startup refresh");
+#if PROVIDER_BENCHMARK_RUNS
+            if (networkReady) runProviderBenchmark();
+#endif
         } else {
-            Serial.println("✗ Location detection failed!");
-            lv_label_set_text(title_label, "Location Failed!");
-            // Don't proceed without location
-            while(1) { delay(1000); }
+            refreshWeather();
         }
 
-        // Configure NTP for UTC time (we'll apply timezone offset from API)
-        lv_label_set_text(title_label, "Syncing Time...");
-        lv_timer_handler();
-        configTime(0, 0, NTP_SERVER1, NTP_SERVER2);  // UTC timezone
-
-        // Wait for time sync
-        Serial.println("\n--- Time Synchronization ---");
-        Serial.println("Waiting for NTP time sync...");
-        int timeWait = 0;
-        while (time(nullptr) < 100000 && timeWait < 20) {
-            delay(500);
+        // A cycle cut short by its time budget hasn't scheduled anything;
+        // retry it on the weather policy
+        if (schedulerMsUntilRefresh() == 0) {
+            schedulerFailed(REFRESH_STEP_WEATHER);
+        }
+    }
+}
+
+#if PROVIDER_BENCHMARK_RUNS
+// Compare the backends on this network; the published forecast and the
+// schedule are left alone
+void runProviderBenchmark() {
+    WeatherProvider* providers[] = {&owmProvider, &openMeteoProvider};
+    providerBenchmark(providers, 2, PROVIDER_BENCHMARK_RUNS, weatherSession, currentLocation);
+    weatherTls.dumpReport();
+    hedgeTls.dumpReport();
+    weatherTls.logCycle(0);   // Don't count these handshakes in the next refresh
+    hedgeTls.logCycle(0);
+}
+#endif
+
+// Fetch and publish a forecast, then schedule the next cycle: the regular
+// interval on success, a backoff retry on failure
+bool fetchAndPublish() {
+    if (!fetchWeatherData(weatherChannel.writeSlot())) {
+        schedulerFailed(REFRESH_STEP_WEATHER);
+        return false;
+    }
+#if DEEP_SLEEP_MODE
+    dutyCycleSave(weatherChannel.writeSlot(), currentLocation, localZone, localZoneValid);
+#endif
+    publishWeather();
+    schedulerSucceeded(REFRESH_STEP_WEATHER);
+    schedulerRefreshIn(UPDATE_INTERVAL_MS);
+    return true;
+}
+
+// WiFi, location and time sync; returns false if weather can't be fetched
+bool startNetwork() {
+    if (warmWake) {
+        // Location, zone rules and the clock survived deep sleep, and the
+        // screen already shows data: reconnect quietly and fetch
+        if (!connectToWiFi()) {
+            Serial.println("✗ WiFi connection failed\n");
+            return false;
+        }
+        refreshBudget.begin();
+        currentLocation = restoredLocation;
+        currentLocation.lastLocationCheck = millis();
+        configTime(0, 0, NTP_SERVER1, NTP_SERVER2);  // Corrects RTC drift in the background
+        return true;
+    }
+
+    postStatus("Connecting WiFi...");
+
+    // Connect to WiFi
+    if (!connectToWiFi()) {
+        postStatus("WiFi Failed!");
+        Serial.println("✗ WiFi connection failed\n");
+        return false;
+    }
+    Serial.println("WiFi connected!");
+    refreshBudget.begin();
+
+    // Get location via WiFi triangulation
+    postStatus("Finding Location...");
+    Serial.println("\n--- Location Detection ---");
+
+    if (getLocationFromWiFi()) {
+        Serial.println("✓ Location acquired successfully");
+        Serial.printf("Coordinates: %.6f, %.6f\n",
+                     currentLocation.latitude, currentLocation.longitude);
+    } else if (restoredLocation.isValid) {
+        // Keep showing weather for where we were last time
+        Serial.println("✗ Location detection failed, using snapshot location");
+        currentLocation = restoredLocation;
+        currentLocation.lastLocationCheck = millis();
+    } else {
+        Serial.println("✗ Location detection failed!");
+        postStatus("Location Failed!");
+        // Don't proceed without location; the UI task keeps running
+        return false;
+    }
+
+    // Configure NTP for UTC time (we'll apply timezone offset from API)
+    postStatus("Syncing Time...");
+    configTime(0, 0, NTP_SERVER1, NTP_SERVER2);  // UTC timezone
+
+    // Wait for time sync
+    Serial.println("\n--- Time Synchronization ---");
+    Serial.println("Waiting for NTP time sync...");
+    int timeWait = 0;
+    int maxWaits = refreshBudget.allow(PHASE_NTP_SYNC) / 500;
+    {
+        PhaseTimer timer(PHASE_NTP_SYNC);
+        while (time(nullptr) < 100000 && timeWait < maxWaits) {
+            vTaskDelay(pdMS_TO_TICKS(500));
             Serial.print(".");
             timeWait++;
         }
-        Serial.println("\n✓ Time synced!");
+    }
+    Serial.println("\n✓ Time synced!");
 
-        lv_label_set_text(title_label, "Fetching Weather...");
-        lv_timer_handler();
-        delay(1000);
+    // Without zone rules the forecast API's fixed offset is used
+    resolveTimezone();
+    return true;
+}
 
-        // Fetch weather (this will also get timezone offset from API)
-        Serial.println("\n--- Weather Data ---");
-        if (fetchWeatherData()) {
-            weatherDataValid = true;
-            updateWeatherDisplay();
-            Serial.println("✓ Weather data loaded successfully\n");
-        } else {
-            lv_label_set_text(title_label, "Weather Fetch Failed");
-            Serial.println("✗ Weather fetch failed\n");
-        }
+// Periodic refresh: check location BEFORE each weather update
+void refreshWeather() {
+    Serial.println("\n--- Periodic Weather Update ---");
+    Serial.println("Checking location before weather update...");
+    refreshBudget.begin();
+
+    // The stack reconnects on its own, but not always
+    if (WiFi.status() != WL_CONNECTED && !connectToWiFi()) {
+        refreshBudget.finish("Refresh");
+        return;
+    }
+
+    // Triangulate to see if location changed
+    bool moved = getLocationFromWiFi();
+    if (refreshBudget.exhausted()) {
+        // Out of time already: keep showing the current forecast
+        refreshBudget.finish("Refresh");
+        return;
+    }
+    if (moved) {
+        // Location changed >5km, fetch weather for new location
+        Serial.println("Location changed significantly! Updating weather for new location...");
+        resolveTimezone();
     } else {
-        lv_label_set_text(title_label, "WiFi Failed!");
-        Serial.println("✗ WiFi connection failed\n");
+        // Location unchanged (<5km difference) or triangulation returned false
+        // Still update weather for current location
+        Serial.println("Location unchanged. Refreshing weather for current location...");
     }
-    
-    // Turn on backlight
-    pinMode(PIN_LCD_BL, OUTPUT);
-    digitalWrite(PIN_LCD_BL, HIGH);
+
+    if (fetchAndPublish()) {
+        Serial.println("✓ Weather data refreshed\n");
+    } else {
+        Serial.println("✗ Weather update failed\n");
+    }
+    weatherTls.logCycle(refreshBudget.spentMs());
+    hedgeTls.logCycle(refreshBudget.spentMs());
+    refreshBudget.finish("Refresh");
 }
 
-void loop() {
-    lv_timer_handler();
-    delay(5);
-
-    // Update weather every 30 minutes
-    // Check location BEFORE each weather update
-    if (weatherDataValid && millis() - lastUpdate > UPDATE_INTERVAL_MS) {
-        Serial.println("\n--- Periodic Weather Update ---");
-        Serial.println("Checking location before weather update...");
-
-        // Triangulate to see if location changed
-        if (getLocationFromWiFi()) {
-            Serial.println("Location changed significantly! Updating weather for new location...");
-            // Location changed >5km, fetch weather for new location
-            if (fetchWeatherData()) {
-                updateWeatherDisplay();
-                Serial.println("✓ Weather updated for new location\n");
-            } else {
-                Serial.println("✗ Weather update failed\n");
-            }
-        } else {
-            // Location unchanged (<5km difference) or triangulation returned false
-            // Still update weather for current location
-            Serial.println("Location unchanged. Refreshing weather for current location...");
-            if (fetchWeatherData()) {
-                updateWeatherDisplay();
-                Serial.println("✓ Weather data refreshed\n");
-            } else {
-                Serial.println("✗ Weather update failed\n");
-            }
+// ========================================
+// UI Task (core 1)
+// ========================================
+void uiTask(void* param) {
+    unsigned long lastPeriodic = millis();
+    uint32_t wakeups = 0;
+
+    for (;;) {
+        wakeups++;
+        powerAcquire(POWER_LOCK_RENDER);
+
+        const char* status = pendingStatus.exchange(nullptr);
+        if (status) {
+            showStatus(status, weatherShown);
+        }
+
+        // Render a newly published snapshot, and periodically re-render
+        // the current one so the stale marker appears on time
+        bool periodic = millis() - lastPeriodic >= UI_STALE_CHECK_MS;
+        bool fresh = weatherChannel.acquire();
+        if (fresh || (weatherShown && periodic)) {
+            renderWeatherDisplay(weatherChannel.current());
+            weatherShown = true;
+        }
+#if DEEP_SLEEP_MODE
+        if (fresh) {
+            Serial.printf("Wake to fresh render: %lu ms\n", millis());
+        }
+#endif
+        if (periodic) {
+            powerLogStats(wakeups);
+            memoryLogSummary();
+            wakeups = 0;
+            lastPeriodic = millis();
+        }
+        while (Serial.available()) {
+            if (Serial.read() == 'p') phaseReportRequested = true;
+        }
+        if (phaseReportRequested) {
+            phaseReportRequested = false;
+            phaseDumpReport();
+            weatherTls.dumpReport();
+#if WEATHER_HEDGE
+            hedgeDumpReport();
+#endif
+            memoryDumpReport();
         }
+
+        // Time until LVGL's next timer (LV_NO_TIMER_READY if none)
+        uint32_t idleMs = lv_timer_handler();
+        powerRelease(POWER_LOCK_RENDER);
+        uiPasses.fetch_add(1);
+
+        // Block until then, the next periodic check, or a notification
+        // from postStatus()/publishWeather()
+        unsigned long sincePeriodic = millis() - lastPeriodic;
+        uint32_t untilPeriodic = (sincePeriodic < UI_STALE_CHECK_MS)
+                                     ? UI_STALE_CHECK_MS - sincePeriodic
+                                     : 0;
+        if (idleMs > untilPeriodic) idleMs = untilPeriodic;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(idleMs));
+    }
+}
+
+void IRAM_ATTR onReportButton() {
+    phaseReportRequested = true;
+    if (uiTaskHandle) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(uiTaskHandle, &woken);
+        if (woken) portYIELD_FROM_ISR();
+    }
+}
+
+// Queue a status message for the UI task; never blocks
+void postStatus(const char* message) {
+    pendingStatus.store(message);
+    if (uiTaskHandle) xTaskNotifyGive(uiTaskHandle);
+}
+
+// Hand the filled write slot to the UI task and wake it
+void publishWeather() {
+    weatherChannel.publish();
+    if (uiTaskHandle) xTaskNotifyGive(uiTaskHandle);
+}
+
+// Block until the UI task has run a full iteration that started after
+// this call, i.e. everything posted so far is on screen
+void waitForUi(uint32_t timeoutMs) {
+    uint32_t start = uiPasses.load();
+    unsigned long waitStart = millis();
+    xTaskNotifyGive(uiTaskHandle);
+    while (uiPasses.load() - start < 2 && millis() - waitStart < timeoutMs) {
+        vTaskDelay(pdMS_TO_TICKS(5));
     }
 }
 
 static bool lvgl_flush_ready(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx) {
     if (is_initialized_lvgl) {
         lv_disp_drv_t *disp_driver = (lv_disp_drv_t *)user_ctx;
+        phaseRecord(PHASE_LVGL_FLUSH, (uint32_t)(esp_timer_get_time() - flushStartUs));
         lv_disp_flush_ready(disp_driver);
     }
     return false;
 }
 
 static void lvgl_flush_cb(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_map) {
+    flushCount++;
+    flushPixels += lv_area_get_size(area);
+    flushStartUs = esp_timer_get_time();
     esp_lcd_panel_handle_t panel_handle = (esp_lcd_panel_handle_t)drv->user_data;
     esp_lcd_panel_draw_bitmap(panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1, color_map);
 }
 
-void initDisplay() {
+// panelKeptFrame: the ST7789 stayed powered through deep sleep, so it is
+// already configured and must not be reset (that would blank it)
+void initDisplay(bool panelKeptFrame) {
     pinMode(PIN_LCD_RD, OUTPUT);
     digitalWrite(PIN_LCD_RD, HIGH);
     
@@ -251,7 +679,7 @@ void initDisplay() {
             PIN_LCD_D4, PIN_LCD_D5, PIN_LCD_D6, PIN_LCD_D7,
         },
         .bus_width = 8,
-        .max_transfer_bytes = LVGL_LCD_BUF_SIZE * sizeof(uint16_t),
+        .max_transfer_bytes = LVGL_DRAW_BUF_SIZE * sizeof(uint16_t),
         .psram_trans_align = 0,
         .sram_trans_align = 0
     };
@@ -282,23 +710,38 @@ void initDisplay() {
         .bits_per_pixel = 16,
     };
     esp_lcd_new_panel_st7789(io_handle, &panel_config, &panel_handle);
-    esp_lcd_panel_reset(panel_handle);
-    esp_lcd_panel_init(panel_handle);
+    if (panelKeptFrame) {
+        // The driver leaves RES low until reset(); keep the panel running
+        pinMode(PIN_LCD_RES, OUTPUT);
+        digitalWrite(PIN_LCD_RES, HIGH);
+    } else {
+        esp_lcd_panel_reset(panel_handle);
+        esp_lcd_panel_init(panel_handle);
+    }
     esp_lcd_panel_invert_color(panel_handle, true);
     esp_lcd_panel_swap_xy(panel_handle, true);
     esp_lcd_panel_mirror(panel_handle, false, true);
     esp_lcd_panel_set_gap(panel_handle, 0, 35);
     
     // Send ST7789 specific commands
-    for (uint8_t i = 0; i < (sizeof(lcd_st7789v) / sizeof(lcd_cmd_t)); i++) {
+    for (uint8_t i = 0; i < (sizeof(lcd_st7789v) / sizeof(lcd_cmd_t)) && !panelKeptFrame; i++) {
         esp_lcd_panel_io_tx_param(io_handle, lcd_st7789v[i].cmd, lcd_st7789v[i].data, lcd_st7789v[i].len & 0x7f);
         if (lcd_st7789v[i].len & 0x80) delay(120);
     }
     
     // Initialize LVGL
     lv_init();
-    lv_disp_buf = (lv_color_t *)heap_caps_malloc(LVGL_LCD_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
-    lv_disp_draw_buf_init(&disp_buf, lv_disp_buf, NULL, LVGL_LCD_BUF_SIZE);
+    lv_disp_buf = (lv_color_t *)heap_caps_malloc(LVGL_DRAW_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+#if LVGL_DOUBLE_BUFFER
+    // Second buffer lets LVGL render the next band while DMA sends this one
+    lv_disp_buf2 = (lv_color_t *)heap_caps_malloc(LVGL_DRAW_BUF_SIZE * sizeof(lv_color_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+#else
+    lv_disp_buf2 = NULL;
+#endif
+    lv_disp_draw_buf_init(&disp_buf, lv_disp_buf, lv_disp_buf2, LVGL_DRAW_BUF_SIZE);
+    Serial.printf("LVGL draw buffers: %s, %u bytes each\n",
+                  lv_disp_buf2 ? "2 x partial" : "1 x full frame",
+                  (unsigned)(LVGL_DRAW_BUF_SIZE * sizeof(lv_color_t)));
     
     lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = EXAMPLE_LCD_H_RES;
@@ -311,373 +754,149 @@ void initDisplay() {
     is_initialized_lvgl = true;
 }
 
-void createUI() {
-    screen = lv_scr_act();
-    lv_obj_set_style_bg_color(screen, lv_color_hex(0x000000), 0);
-    
-    // Title (used for status messages during startup)
-    title_label = lv_label_create(screen);
-    lv_label_set_text(title_label, "Weather Station");
-    lv_obj_set_style_text_color(title_label, lv_color_hex(0x00FFFF), 0);
-    lv_obj_set_style_text_font(title_label, &lv_font_montserrat_14, 0);
-    lv_obj_align(title_label, LV_ALIGN_CENTER, 0, 0);
-    
-    // Create 3 horizontal weather tiles
-    int tile_width = 100;
-    int tile_spacing = 6;
-    int start_x = (320 - (tile_width * 3 + tile_spacing * 2)) / 2;
-    
-    for (int i = 0; i < 3; i++) {
-        int x_pos = start_x + (i * (tile_width + tile_spacing));
-        
-        // Day name label (at top of tile)
-        day_labels[i] = lv_label_create(screen);
-        lv_obj_set_style_text_color(day_labels[i], lv_color_hex(0xFFFFFF), 0);
-        lv_obj_set_style_text_font(day_labels[i], &lv_font_montserrat_12, 0);
-        lv_obj_set_pos(day_labels[i], x_pos, 10);
-        lv_obj_set_width(day_labels[i], tile_width);
-        lv_obj_set_style_text_align(day_labels[i], LV_TEXT_ALIGN_CENTER, 0);
-        
-        // Temperature label (LARGE, moved down slightly)
-        temp_labels[i] = lv_label_create(screen);
-        lv_obj_set_style_text_color(temp_labels[i], lv_color_hex(0xFFFF00), 0);
-        lv_obj_set_style_text_font(temp_labels[i], &lv_font_montserrat_24, 0);
-        lv_obj_set_pos(temp_labels[i], x_pos, 65);
-        lv_obj_set_width(temp_labels[i], tile_width);
-        lv_obj_set_style_text_align(temp_labels[i], LV_TEXT_ALIGN_CENTER, 0);
-        
-        // Description label (near bottom, multi-line, size 18)
-        desc_labels[i] = lv_label_create(screen);
-        lv_obj_set_style_text_color(desc_labels[i], lv_color_hex(0xAAAAAA), 0);
-        lv_obj_set_style_text_font(desc_labels[i], &lv_font_montserrat_18, 0);
-        lv_obj_set_pos(desc_labels[i], x_pos, 120);
-        lv_obj_set_width(desc_labels[i], tile_width);
-        lv_obj_set_style_text_align(desc_labels[i], LV_TEXT_ALIGN_CENTER, 0);
-        lv_label_set_long_mode(desc_labels[i], LV_LABEL_LONG_WRAP);
-    }
-    
-    // Update label - initially hidden, will be used for status messages
-    update_label = lv_label_create(screen);
-    lv_obj_set_style_text_color(update_label, lv_color_hex(0x00FF00), 0);
-    lv_obj_set_style_text_font(update_label, &lv_font_montserrat_14, 0);
-    lv_obj_align(update_label, LV_ALIGN_BOTTOM_MID, 0, -5);
-    lv_obj_add_flag(update_label, LV_OBJ_FLAG_HIDDEN);
-}
-
-void updateWeatherDisplay() {
-    // Hide startup message
-    lv_obj_add_flag(title_label, LV_OBJ_FLAG_HIDDEN);
-    
-    // Check if data is stale (older than 2 hours)
-    bool isStale = (millis() - lastUpdate) > (2 * 60 * 60 * 1000);
-    
-    for (int i = 0; i < 3; i++) {
-        // Day 0: Show current temp instead of day/date
-        // Days 1-2: Show day name and date
-        if (i == 0) {
-            // Current temperature displayed where day/date usually goes
-            String current_text = String(currentTemp) + "F";
-            lv_label_set_text(day_labels[i], current_text.c_str());
-            lv_obj_set_style_text_color(day_labels[i], lv_color_hex(0x00FFFF), 0); // Cyan for current
-            lv_obj_set_style_text_font(day_labels[i], &lv_font_montserrat_26, 0); // Larger than temps
-        } else {
-            // Normal day/date display
-            String day_text = forecast[i].day_name + "\n" + forecast[i].date;
-            lv_label_set_text(day_labels[i], day_text.c_str());
-            lv_obj_set_style_text_color(day_labels[i], lv_color_hex(0xFFFFFF), 0);
-            lv_obj_set_style_text_font(day_labels[i], &lv_font_montserrat_12, 0);
-        }
-        
-        // Temperature with red asterisk if stale
-        String temp_text;
-        if (isStale) {
-            temp_text = "*" + String(forecast[i].temp_high) + "/" + String(forecast[i].temp_low) + "F";
-            lv_obj_set_style_text_color(temp_labels[i], lv_color_hex(0xFF0000), 0); // Red when stale
-        } else {
-            temp_text = String(forecast[i].temp_high) + "/" + String(forecast[i].temp_low) + "F";
-            lv_obj_set_style_text_color(temp_labels[i], lv_color_hex(0xFFFF00), 0); // Yellow when fresh
-        }
-        lv_label_set_text(temp_labels[i], temp_text.c_str());
-        
-        // Description
-        String desc;
-        if (i == 0) {
-            // Day 0: Show current conditions in cyan
-            desc = currentCondition;
-            if (desc.length() > 0) {
-                desc[0] = toupper(desc[0]);
-            }
-            lv_label_set_text(desc_labels[i], desc.c_str());
-            lv_obj_set_style_text_color(desc_labels[i], lv_color_hex(0x00FFFF), 0); // Cyan to match current temp
-        } else {
-            // Days 1-2: Show forecast in gray
-            desc = forecast[i].description;
-            if (desc.length() > 0) {
-                desc[0] = toupper(desc[0]);
-            }
-            lv_label_set_text(desc_labels[i], desc.c_str());
-            lv_obj_set_style_text_color(desc_labels[i], lv_color_hex(0xAAAAAA), 0); // Gray
-        }
+// Update the labels and render them immediately, reporting how long the
+// render plus the final DMA transfer took in the current buffer mode
+void renderWeatherDisplay(const WeatherSnapshot& weather) {
+    uint32_t startFlushes = flushCount;
+    uint32_t startPixels = flushPixels;
+    unsigned long start = micros();
+
+    memoryEnter(MEM_SPAN_RENDER);
+    int changes;
+    {
+        PhaseTimer timer(PHASE_UI_UPDATE);
+        changes = updateWeatherDisplay(weather, time(nullptr));
     }
+    lv_refr_now(NULL);
+    while (disp_buf.flushing) {}  // Wait for the last transfer to finish
+    memoryLeave(MEM_SPAN_RENDER);
+
+    Serial.printf("Render+flush: %lu us, %d label changes, %u flushes, %u px (%s)\n",
+                  micros() - start, changes,
+                  (unsigned)(flushCount - startFlushes),
+                  (unsigned)(flushPixels - startPixels),
+                  LVGL_DOUBLE_BUFFER ? "double partial buffer" : "single full buffer");
 }
 
+// Cached AP/channel/IP first, full scan only if that fails
 bool connectToWiFi() {
-    WiFi.disconnect(true);
-    delay(100);
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    
-    int attempts = 0;
-    while (WiFi.status() != WL_CONNECTED && attempts < 30) {
-        delay(500);
-        Serial.print(".");
-        attempts++;
+    PhaseTimer timer(PHASE_WIFI_CONNECT);
+    if (!connectWiFiFast(WIFI_SSID, WIFI_PASSWORD)) {
+        schedulerFailed(REFRESH_STEP_WIFI);
+        return false;
     }
-    
-    return (WiFi.status() == WL_CONNECTED);
+    schedulerSucceeded(REFRESH_STEP_WIFI);
+    return true;
 }
 
-bool fetchWeatherData() {
+// Fills the given snapshot; it is only published by the caller on success
+bool fetchWeatherData(WeatherSnapshot& weather) {
     if (WiFi.status() != WL_CONNECTED) return false;
+    if (refreshBudget.exhausted()) {
+        LOG_WARN("Refresh out of time, weather fetch skipped\n");
+        return false;
+    }
+    if (!schedulerTakeWeatherCalls(weatherProvider, true)) return false;
 
     // Check if we have a valid location
     if (!currentLocation.isValid) {
-        Serial.println("ERROR: No valid location available for weather fetch");
+        LOG_ERROR("ERROR: No valid location available for weather fetch\n");
         return false;
     }
 
-    HTTPClient http;
-
-    // STEP 1: Get ACTUAL current weather using dynamic coordinates
-    String currentUrl = "http://api.openweathermap.org/data/2.5/weather?lat=" +
-                        String(currentLocation.latitude, 6) + "&lon=" +
-                        String(currentLocation.longitude, 6) +
-                        "&appid=" + String(OPENWEATHER_API_KEY) +
-                        "&units=" + String(UNITS);
-    
-    Serial.println("Fetching current weather...");
-    http.begin(currentUrl);
-    int httpCode = http.GET();
-    
-    if (httpCode != 200) {
-        Serial.printf("Current weather HTTP error: %d\n", httpCode);
-        http.end();
+    // ~3.5 KB of hourly points: too big for the task stack
+    static WeatherReport report;
+#if WEATHER_HEDGE
+    WeatherProvider* source = hedgedFetch(weatherProvider, weatherSession, hedgeProvider,
+                                          hedgeSession, currentLocation, report);
+    if (!source) {
         return false;
     }
-    
-    String currentPayload = http.getString();
-    http.end();
-    
-    JsonDocument currentDoc;
-    DeserializationError error = deserializeJson(currentDoc, currentPayload);
-    
-    if (error) {
-        Serial.print("Current weather JSON error: ");
-        Serial.println(error.c_str());
+#else
+    WeatherProvider* source = &weatherProvider;
+    if (!weatherProvider.fetch(weatherSession, currentLocation, report)) {
         return false;
     }
-    
-    // Get location name returned by API to verify we have the right place
-    String locationName = currentDoc["name"].as<String>();
-    currentLocation.city = locationName;  // Store city name
-    Serial.printf("Location: %s (%.6f, %.6f)\n", locationName.c_str(),
-                 currentLocation.latitude, currentLocation.longitude);
-
-    // Get current conditions (but we'll use forecast temp instead)
-    currentCondition = currentDoc["weather"][0]["description"].as<String>();
-
-    Serial.printf("Current Weather API conditions: %s\n", currentCondition.c_str());
-
-    // STEP 2: Get forecast data using dynamic coordinates
-    String forecastUrl = "http://api.openweathermap.org/data/2.5/forecast?lat=" +
-                         String(currentLocation.latitude, 6) + "&lon=" +
-                         String(currentLocation.longitude, 6) +
-                         "&appid=" + String(OPENWEATHER_API_KEY) +
-                         "&units=" + String(UNITS) + "&cnt=40";  // Get 5 days worth
-    
-    Serial.println("Fetching forecast...");
-    http.begin(forecastUrl);
-    httpCode = http.GET();
-    
-    if (httpCode != 200) {
-        Serial.printf("Forecast HTTP error: %d\n", httpCode);
-        http.end();
-        return false;
+#endif
+
+    // Keep the connections warm only if the next refresh comes before a
+    // server would drop them anyway
+    if (UPDATE_INTERVAL_MS > HTTP_KEEPALIVE_IDLE_MS) {
+        weatherSession.close();
+        hedgeSession.close();
     }
-    
-    String payload = http.getString();
-    http.end();
-    
-    JsonDocument doc;
-    error = deserializeJson(doc, payload);
-    
-    if (error) {
-        Serial.print("Forecast JSON error: ");
-        Serial.println(error.c_str());
-        return false;
+    LOG_INFO("Weather fetch total: %lu ms (%s)\n",
+             (unsigned long)source->lastCost().fetchMs, source->name());
+
+    // Get location name returned by API to verify we have the right place
+    if (report.city[0]) {
+        strlcpy(currentLocation.city, report.city, sizeof(currentLocation.city));
     }
-    
-    // Get timezone offset from API (in seconds from UTC)
-    timezoneOffset = doc["city"]["timezone"].as<long>();
-    Serial.printf("Timezone offset from API: %ld seconds (%d hours)\n", timezoneOffset, (int)(timezoneOffset / 3600));
-    
-    // Get the first forecast entry temperature (most recent/next 3-hour block)
-    int firstForecastTemp = round(doc["list"][0]["main"]["temp"].as<float>());
-    Serial.printf("First Forecast Entry: %dF\n", firstForecastTemp);
-    
-    // Use the forecast temperature if it's more recent (for small towns, forecast is more reliable)
-    currentTemp = firstForecastTemp;
+    LOG_INFO("Location: %s (%.6f, %.6f)\n", currentLocation.city,
+            currentLocation.latitude, currentLocation.longitude);
+
+    strlcpy(weather.currentCondition, report.currentCondition, sizeof(weather.currentCondition));
+    weather.timezoneOffset = report.utcOffset;
+
+    // OWM: the first forecast entry (for small towns, forecast is more
+    // reliable than the nearest station); Open-Meteo: the current model value
+    weather.currentTemp = report.currentTemp;
     
     // Process forecast data - group by actual calendar date
-    Serial.println("Processing forecast by calendar date...");
-    
-    // Get current local date using timezone offset from API
+    LOG_INFO("Processing forecast by calendar date...\n");
+    unsigned long aggStart = micros();
+
+    // UTC offsets for the forecast window come from the zone's DST rules,
+    // so entries after a DST change still land on the right local day.
+    // If the rules disagree with the API's current offset (unknown or
+    // wrong zone), fall back to the API's single offset.
     time_t now = time(nullptr);
-    time_t localTime = now + timezoneOffset;
-    struct tm* timeinfo = gmtime(&localTime);
-    char currentDate[11];
-    strftime(currentDate, sizeof(currentDate), "%Y-%m-%d", timeinfo);
-    Serial.printf("Local date for grouping: %s (UTC+%d)\n", currentDate, (int)(timezoneOffset / 3600));
-    
-    // Arrays to hold min/max for each of 3 days
-    float dayHighs[3] = {-999, -999, -999};
-    float dayLows[3] = {999, 999, 999};
-    String dayDescriptions[3] = {"", "", ""};
-    String dayDates[3] = {"", "", ""};
-    int dayHumiditySums[3] = {0, 0, 0};
-    int dayHumidityCounts[3] = {0, 0, 0};
-    
-    // Process all forecast entries and group by date
-    int listSize = doc["list"].size();
-    for (int i = 0; i < listSize; i++) {
-        JsonObject item = doc["list"][i];
-        
-        // Get Unix timestamp (in UTC) and convert to local time using API timezone offset
-        long dt = item["dt"].as<long>();
-        time_t forecast_time = (time_t)(dt + timezoneOffset);
-        
-        // Convert to local date string
-        struct tm* forecast_tm = gmtime(&forecast_time);
-        char forecastDate[11];
-        strftime(forecastDate, sizeof(forecastDate), "%Y-%m-%d", forecast_tm);
-        char forecastTime[6];
-        strftime(forecastTime, sizeof(forecastTime), "%H:%M", forecast_tm);
-        
-        // Determine which day this forecast belongs to (0=today, 1=tomorrow, 2=day after)
-        int dayIndex = -1;
-        
-        // Compare dates to determine day index
-        if (strcmp(forecastDate, currentDate) == 0) {
-            dayIndex = 0;  // Today
-        } else if (dayDates[1] == "" || dayDates[1] == forecastDate) {
-            dayIndex = 1;  // Tomorrow
-            if (dayDates[1] == "") dayDates[1] = forecastDate;
-        } else if (dayDates[2] == "" || dayDates[2] == forecastDate) {
-            dayIndex = 2;  // Day after tomorrow
-            if (dayDates[2] == "") dayDates[2] = forecastDate;
-        } else {
-            continue;  // Skip if beyond 3 days
-        }
-        
-        // Store date for this day
-        if (dayDates[dayIndex] == "") {
-            dayDates[dayIndex] = forecastDate;
-        }
-        
-        // Get temperature and update min/max
-        float temp = item["main"]["temp"].as<float>();
-        if (temp > dayHighs[dayIndex]) {
-            dayHighs[dayIndex] = temp;
-        }
-        if (temp < dayLows[dayIndex]) {
-            dayLows[dayIndex] = temp;
-        }
-        
-        // Accumulate humidity
-        dayHumiditySums[dayIndex] += item["main"]["humidity"].as<int>();
-        dayHumidityCounts[dayIndex]++;
-        
-        // Use midday description (12:00-15:00 preferred)
-        if (dayDescriptions[dayIndex] == "" || 
-            (strcmp(forecastTime, "12:00") >= 0 && strcmp(forecastTime, "15:00") <= 0)) {
-            dayDescriptions[dayIndex] = item["weather"][0]["description"].as<String>();
-        }
+    TzTransitionCache tzCache;
+    if (localZoneValid) {
+        tzCache.build(localZone, now - 24 * 3600, now + 6 * 24 * 3600);
     }
-    
-    // Populate forecast array with processed data
-    dayDates[0] = currentDate;  // Ensure today is set
-    for (int day = 0; day < 3; day++) {
-        forecast[day].day_name = getDayName(dayDates[day]);
-        forecast[day].date = dayDates[day].substring(5, 10);  // "MM-DD"
-        forecast[day].description = dayDescriptions[day];
-        
-        // Handle missing or partial forecast data
-        if (dayHighs[day] <= -999 || dayLows[day] >= 999) {
-            Serial.printf("No forecast data for day %d\n", day);
-            // For today (day 0), if we have no forecast entries remaining,
-            // treat current temp as the high since it's likely late in the day
-            if (day == 0) {
-                forecast[day].temp_high = currentTemp;
-                forecast[day].temp_low = currentTemp;
-                Serial.printf("Late in day - using current temp for day 0: %d/%dF\n", currentTemp, currentTemp);
-            } else {
-                // For future days, show 0/0 to indicate no data
-                forecast[day].temp_high = 0;
-                forecast[day].temp_low = 0;
-            }
-        } else {
-            // We have forecast data - use it
-            forecast[day].temp_high = round(dayHighs[day]);
-            forecast[day].temp_low = round(dayLows[day]);
-            
-            // Special handling for Day 0: if current temp is higher than forecast high,
-            // use current temp as the high (in case we're past the forecasted peak)
-            if (day == 0 && currentTemp > forecast[day].temp_high) {
-                Serial.printf("Current temp (%dF) exceeds forecast high (%dF), using current as high\n", 
-                             currentTemp, forecast[day].temp_high);
-                forecast[day].temp_high = currentTemp;
-            }
-            // Similarly, if current temp is lower than forecast low, use current as low
-            if (day == 0 && currentTemp < forecast[day].temp_low) {
-                Serial.printf("Current temp (%dF) below forecast low (%dF), using current as low\n", 
-                             currentTemp, forecast[day].temp_low);
-                forecast[day].temp_low = currentTemp;
-            }
+    if (!localZoneValid || tzCache.offsetAt(now) != weather.timezoneOffset) {
+        if (localZoneValid) {
+            LOG_WARN("Zone rules give %d s, API says %d s; using API offset\n",
+                     (int)tzCache.offsetAt(now), (int)weather.timezoneOffset);
         }
-        
-        forecast[day].humidity = dayHumidityCounts[day] > 0 ? 
-                                 dayHumiditySums[day] / dayHumidityCounts[day] : 0;
-        
-        Serial.printf("Day %d: %s %s, %d/%dF, %s\n", 
-                     day, forecast[day].day_name.c_str(), forecast[day].date.c_str(),
-                     forecast[day].temp_low, forecast[day].temp_high,
-                     forecast[day].description.c_str());
+        tzCache.buildFixed(weather.timezoneOffset);
     }
-    
-    lastUpdate = millis();
-    return true;
-}
 
-String getDayName(const String& dateStr) {
-    // dateStr format: "YYYY-MM-DD"
-    const char* days[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    // Slot 0 is the current local date
+    ForecastAggregator aggregator;
+    aggregator.begin(now, tzCache.offsetAt(now));
 
-    // Parse the date string
-    int year = dateStr.substring(0, 4).toInt();
-    int month = dateStr.substring(5, 7).toInt();
-    int day = dateStr.substring(8, 10).toInt();
-
-    // Create tm struct
-    struct tm timeinfo = {0};
-    timeinfo.tm_year = year - 1900;
-    timeinfo.tm_mon = month - 1;
-    timeinfo.tm_mday = day;
+    // Single pass over the hourly series, grouped by local day number
+    for (int i = 0; i < report.hourlyCount; i++) {
+        const HourlyPoint& point = report.hourly[i];
+        aggregator.add(point.dt, tzCache.offsetAt(point.dt), point.temp, point.humidity,
+                       point.description);
+    }
+    aggregator.finish();
+    unsigned long aggUs = micros() - aggStart;
+    phaseRecord(PHASE_AGGREGATION, aggUs);
+    LOG_INFO("Aggregated %d entries in %lu us (%d DST transitions in window)\n",
+             (int)report.hourlyCount, aggUs, tzCache.transitionCount());
 
-    // Convert to time_t and back to get day of week
-    time_t timestamp = mktime(&timeinfo);
-    struct tm* result = localtime(&timestamp);
+    // Populate forecast array with processed data
+    fillForecastDays(aggregator, report.daily, report.dailyCount, weather.currentTemp,
+                     weather.forecast);
+    for (int day = 0; day < 3; day++) {
+        const WeatherDay& out = weather.forecast[day];
+        LOG_INFO("Day %d: %s %s, %.1f/%.1fF, %s\n", 
+                day, out.day_name, out.date,
+                out.temp_low / 10.0f, out.temp_high / 10.0f, out.description);
+    }
+    
+    weather.fetchedAt = time(nullptr);
+    weather.restored = false;
 
-    return String(days[result->tm_wday]);
+    // Persist for instant display on the next boot
+    if (!saveWeatherSnapshot(weather, currentLocation)) {
+        LOG_WARN("Warning: failed to save forecast snapshot\n");
+    }
+    return true;
 }
 
 // ========================================
@@ -700,6 +919,7 @@ void validateAPIKeys() {
     #endif
 
     // Check if default placeholder values are still in use
+#if WEATHER_PROVIDER == WEATHER_PROVIDER_OWM || WEATHER_HEDGE
     if (strcmp(OPENWEATHER_API_KEY, "your_openweather_api_key_here") == 0) {
         Serial.println("\n========================================");
         Serial.println("ERROR: OpenWeatherMap API key not configured!");
@@ -711,6 +931,7 @@ void validateAPIKeys() {
         Serial.println("========================================\n");
         while(1) { delay(1000); } // Halt execution
     }
+#endif
 
     if (strcmp(GOOGLE_GEOLOCATION_API_KEY, "your_google_geolocation_api_key_here") == 0) {
         Serial.println("\n========================================");
@@ -740,49 +961,91 @@ void validateAPIKeys() {
 // WiFi Triangulation & Location Functions
 // ========================================
 bool getLocationFromWiFi() {
-    Serial.println("Getting location via WiFi triangulation...");
+    LOG_INFO("Getting location via WiFi triangulation...\n");
 
     // Check if user wants to always use fallback location
     #ifdef USE_FALLBACK_LOCATION
     if (USE_FALLBACK_LOCATION) {
-        Serial.println("Using fallback location (USE_FALLBACK_LOCATION = true)");
+        LOG_INFO("Using fallback location (USE_FALLBACK_LOCATION = true)\n");
 
         #ifdef FALLBACK_LATITUDE
         #ifdef FALLBACK_LONGITUDE
         if (strcmp(FALLBACK_LATITUDE, "your_latitude_here") != 0 &&
             strcmp(FALLBACK_LONGITUDE, "your_longitude_here") != 0) {
-            currentLocation.latitude = String(FALLBACK_LATITUDE).toFloat();
-            currentLocation.longitude = String(FALLBACK_LONGITUDE).toFloat();
+            currentLocation.latitude = atof(FALLBACK_LATITUDE);
+            currentLocation.longitude = atof(FALLBACK_LONGITUDE);
             currentLocation.lastLocationCheck = millis();
             currentLocation.isValid = true;
-            Serial.printf("Fallback location set: %f, %f\n",
-                         currentLocation.latitude, currentLocation.longitude);
+            LOG_INFO("Fallback location set: %f, %f\n",
+                    currentLocation.latitude, currentLocation.longitude);
             return true;
         }
         #endif
         #endif
 
-        Serial.println("ERROR: Fallback location not configured in secrets.h!");
+        LOG_ERROR("ERROR: Fallback location not configured in secrets.h!\n");
         return false;
     }
     #endif
 
-    // Try WiFi triangulation
-    WifiLocation location(GOOGLE_GEOLOCATION_API_KEY);
-
-    location_t loc = location.getGeoFromWiFi();
+    // A known WiFi environment resolves locally; only new ones go to the
+    // Geolocation API (which runs its own scan)
+    unsigned long locateStart = millis();
+    LocationFingerprint fingerprint;
+    bool haveFingerprint = scanLocationFingerprint(fingerprint);
+    location_t loc;
+    if (haveFingerprint && lookupCachedLocation(fingerprint, loc.lat, loc.lon, loc.accuracy)) {
+        LOG_INFO("Location resolved from cache in %lu ms\n", millis() - locateStart);
+    } else {
+        // Try WiFi triangulation. The library can't be interrupted, so a
+        // result that arrives after its share of the budget is dropped.
+        if (!schedulerStepReady(REFRESH_STEP_GEOLOCATION)) {
+            LOG_WARN("Geolocation backing off, keeping current location\n");
+            return false;
+        }
+        if (refreshBudget.cannotStart(PHASE_GEOLOCATION) ||
+            !schedulerTakeCalls(REFRESH_STEP_GEOLOCATION, 1)) {
+            return false;
+        }
+        uint32_t allowedMs = refreshBudget.allow(PHASE_GEOLOCATION);
+        unsigned long apiStart = millis();
+        {
+            PhaseTimer timer(PHASE_GEOLOCATION);
+            MemoryScope memory(MEM_SPAN_GEOLOCATION);
+#ifdef GEOLOCATION_API_HOST
+            if (!geolocateOverHttp(loc)) loc.accuracy = 0;
+#else
+            WifiLocation location(GOOGLE_GEOLOCATION_API_KEY);
+            loc = location.getGeoFromWiFi();
+#endif
+        }
+        if (millis() - apiStart > allowedMs) {
+            refreshBudget.exhaust(PHASE_GEOLOCATION);
+            schedulerFailed(REFRESH_STEP_GEOLOCATION);
+            return false;
+        }
+        if (loc.accuracy > 0) {
+            schedulerSucceeded(REFRESH_STEP_GEOLOCATION);
+        } else {
+            schedulerFailed(REFRESH_STEP_GEOLOCATION);
+        }
+        LOG_INFO("Location resolved by Geolocation API in %lu ms\n", millis() - locateStart);
+        if (haveFingerprint && loc.accuracy > 0) {
+            storeCachedLocation(fingerprint, loc.lat, loc.lon, loc.accuracy);
+        }
+    }
 
     if (loc.accuracy > 0) {
         float newLat = loc.lat;
         float newLon = loc.lon;
 
-        Serial.println("✓ WiFi TRIANGULATION SUCCESSFUL!");
-        Serial.printf("   Location: %f, %f (accuracy: %.0fm)\n",
-                     newLat, newLon, loc.accuracy);
+        LOG_INFO("✓ WiFi TRIANGULATION SUCCESSFUL!\n");
+        LOG_INFO("   Location: %f, %f (accuracy: %.0fm)\n",
+                newLat, newLon, loc.accuracy);
 
         // Check if location changed significantly
         if (currentLocation.isValid && !locationChanged(newLat, newLon)) {
-            Serial.println("Location hasn't changed significantly, skipping weather update");
+            LOG_INFO("Location hasn't changed significantly, skipping weather update\n");
             currentLocation.lastLocationCheck = millis();
             return false; // Location didn't change enough to warrant update
         }
@@ -795,8 +1058,8 @@ bool getLocationFromWiFi() {
 
         return true; // Location updated successfully
     } else {
-        Serial.println("✗ WiFi TRIANGULATION FAILED!");
-        Serial.printf("   API returned accuracy: %.0fm (need >0 for success)\n", loc.accuracy);
+        LOG_ERROR("✗ WiFi TRIANGULATION FAILED!\n");
+        LOG_INFO("   API returned accuracy: %.0fm (need >0 for success)\n", loc.accuracy);
 
         // Try fallback location
         #ifdef FALLBACK_LATITUDE
@@ -804,13 +1067,13 @@ bool getLocationFromWiFi() {
         if (!currentLocation.isValid &&
             strcmp(FALLBACK_LATITUDE, "your_latitude_here") != 0 &&
             strcmp(FALLBACK_LONGITUDE, "your_longitude_here") != 0) {
-            Serial.println("→ USING FALLBACK LOCATION (from secrets.h)");
-            currentLocation.latitude = String(FALLBACK_LATITUDE).toFloat();
-            currentLocation.longitude = String(FALLBACK_LONGITUDE).toFloat();
+            LOG_INFO("→ USING FALLBACK LOCATION (from secrets.h)\n");
+            currentLocation.latitude = atof(FALLBACK_LATITUDE);
+            currentLocation.longitude = atof(FALLBACK_LONGITUDE);
             currentLocation.lastLocationCheck = millis();
             currentLocation.isValid = true;
-            Serial.printf("   Fallback coordinates: %f, %f\n",
-                         currentLocation.latitude, currentLocation.longitude);
+            LOG_INFO("   Fallback coordinates: %f, %f\n",
+                    currentLocation.latitude, currentLocation.longitude);
             return true;
         }
         #endif
@@ -842,8 +1105,105 @@ bool locationChanged(float newLat, float newLon) {
         newLat, newLon
     );
 
-    Serial.printf("Distance from previous location: %.2f km (threshold: %.2f km)\n",
-                 distance, LOCATION_CHANGE_THRESHOLD_KM);
+    LOG_INFO("Distance from previous location: %.2f km (threshold: %.2f km)\n",
+            distance, LOCATION_CHANGE_THRESHOLD_KM);
 
     return (distance >= LOCATION_CHANGE_THRESHOLD_KM);
 }
+
+#ifdef GEOLOCATION_API_HOST
+// Same request the WifiLocation library makes, but over plain HTTP to the
+// configured host: the visible APs as JSON, answered with lat/lng/accuracy
+bool geolocateOverHttp(location_t& loc) {
+    int found = WiFi.scanNetworks();
+    if (found < 0) found = 0;
+    if (found > GEOLOCATION_MAX_APS) found = GEOLOCATION_MAX_APS;
+
+    // Re-sent on reconnect, so it must outlive the response
+    static char body[64 + GEOLOCATION_MAX_APS * 80];
+    int len = snprintf(body, sizeof(body), "{\"considerIp\":false,\"wifiAccessPoints\":[");
+    for (int i = 0; i < found && len < (int)sizeof(body); i++) {
+        const uint8_t* b = WiFi.BSSID(i);
+        len += snprintf(body + len, sizeof(body) - len,
+                        "%s{\"macAddress\":\"%02X:%02X:%02X:%02X:%02X:%02X\","
+                        "\"signalStrength\":%d,\"channel\":%d}",
+                        i ? "," : "", b[0], b[1], b[2], b[3], b[4], b[5],
+                        (int)WiFi.RSSI(i), (int)WiFi.channel(i));
+    }
+    WiFi.scanDelete();
+    if (len < (int)sizeof(body)) {
+        len += snprintf(body + len, sizeof(body) - len, "]}");
+    }
+    if (len >= (int)sizeof(body)) return false;
+
+    char path[HTTP_PATH_MAX];
+    snprintf(path, sizeof(path), "%s%s", GEOLOCATION_API_PATH, GOOGLE_GEOLOCATION_API_KEY);
+
+    HttpSession session;
+    session.setBudget(&refreshBudget);
+    int status = -1;
+    if (session.connect(GEOLOCATION_API_HOST, GEOLOCATION_API_PORT) &&
+        session.sendPost(path, body)) {
+        status = session.readResponse();
+    }
+    if (status != 200) {
+        Serial.printf("Geolocation HTTP error: %d\n", status);
+        session.close();
+        return false;
+    }
+
+    JsonDocument filter;
+    filter["location"]["lat"] = true;
+    filter["location"]["lng"] = true;
+    filter["accuracy"] = true;
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, session.body(),
+                                                 DeserializationOption::Filter(filter));
+    session.finishResponse("geolocation");
+    session.close();
+    if (error) {
+        Serial.printf("Geolocation JSON error: %s\n", error.c_str());
+        return false;
+    }
+
+    loc.lat = doc["location"]["lat"].as<float>();
+    loc.lon = doc["location"]["lng"].as<float>();
+    loc.accuracy = doc["accuracy"].as<float>();
+    return true;
+}
+#endif
+
+// Look up the DST rules for the local zone: CUSTOM_TIMEZONE if set,
+// otherwise the zone name reported by the IP timezone API if enabled
+bool resolveTimezone() {
+    char name[48] = "";
+#ifdef CUSTOM_TIMEZONE
+    strlcpy(name, CUSTOM_TIMEZONE, sizeof(name));
+#elif !TIMEZONE_IP_LOOKUP
+    Serial.println("No CUSTOM_TIMEZONE set, using forecast offset");
+    return false;
+#else
+    if (!weatherSession.connect(TIMEZONE_API_HOST, TIMEZONE_API_PORT) ||
+        !weatherSession.sendGet(TIMEZONE_API_PATH) ||
+        weatherSession.readResponse() != 200) {
+        Serial.println("✗ Timezone lookup failed, using forecast offset");
+        weatherSession.close();
+        return false;
+    }
+    // Plain-text body: "America/Chicago\n"
+    size_t len = weatherSession.body().readBytesUntil('\n', name, sizeof(name) - 1);
+    name[len] = '\0';
+    weatherSession.finishResponse("timezone");
+    weatherSession.close();
+#endif
+
+    const char* spec = lookupPosixTz(name);
+    if (!spec || !parsePosixTz(spec, localZone)) {
+        Serial.printf("✗ Unknown timezone '%s', using forecast offset\n", name);
+        localZoneValid = false;
+        return false;
+    }
+    localZoneValid = true;
+    Serial.printf("✓ Timezone: %s (%s)\n", name, spec);
+    return true;
+}
@@ -0,0 +1,115 @@
+#include "memory_monitor.h"
+
+#include "Arduino.h"
+#include "esp_heap_caps.h"
+
+struct MemSample {
+    uint32_t internalFree;
+    uint32_t internalLargest;
+    uint32_t dmaFree;
+    uint32_t psramFree;
+};
+
+struct MemSpanStats {
+    uint32_t count;
+    MemSample entry;              // Last entry sample, paired with exit below
+    int32_t worstDelta;           // Most internal heap still held on exit
+    uint32_t lowestFree;          // Internal free, minimum over entry and exit
+    uint32_t lowestLargest;       // Largest internal block, same
+    uint32_t lowestDma;           // DMA-capable free, same
+    uint32_t lowestPsram;         // PSRAM free, same (0 without PSRAM)
+    uint32_t lowestStack;         // Stack high-water mark of the task, bytes
+};
+
+static MemSpanStats spans[MEM_SPAN_COUNT];
+static TaskHandle_t watchedTasks[MEMORY_MAX_TASKS];
+static int watchedCount = 0;
+
+static const char* const SPAN_NAMES[MEM_SPAN_COUNT] = {
+    "geolocation", "http body", "json parse", "render",
+};
+
+static void sample(MemSample& s) {
+    s.internalFree = heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s.internalLargest = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    s.dmaFree = heap_caps_get_free_size(MALLOC_CAP_DMA);
+    s.psramFree = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+}
+
+static void track(MemSpanStats& st, const MemSample& s) {
+    if (st.lowestFree == 0 || s.internalFree < st.lowestFree) st.lowestFree = s.internalFree;
+    if (st.lowestLargest == 0 || s.internalLargest < st.lowestLargest) {
+        st.lowestLargest = s.internalLargest;
+    }
+    if (st.lowestDma == 0 || s.dmaFree < st.lowestDma) st.lowestDma = s.dmaFree;
+    if (st.lowestPsram == 0 || s.psramFree < st.lowestPsram) st.lowestPsram = s.psramFree;
+    // FreeRTOS on ESP32 reports the high-water mark in bytes
+    uint32_t stack = uxTaskGetStackHighWaterMark(NULL);
+    if (st.lowestStack == 0 || stack < st.lowestStack) st.lowestStack = stack;
+}
+
+void memoryEnter(MemSpan span) {
+    MemSpanStats& st = spans[span];
+    sample(st.entry);
+    track(st, st.entry);
+}
+
+void memoryLeave(MemSpan span) {
+    MemSpanStats& st = spans[span];
+    MemSample exit;
+    sample(exit);
+    track(st, exit);
+
+    int32_t delta = (int32_t)st.entry.internalFree - (int32_t)exit.internalFree;
+    if (st.count == 0 || delta > st.worstDelta) st.worstDelta = delta;
+    st.count++;
+}
+
+void memoryWatchTask(TaskHandle_t task) {
+    if (task && watchedCount < MEMORY_MAX_TASKS) {
+        watchedTasks[watchedCount++] = task;
+    }
+}
+
+void memoryLogSummary() {
+    Serial.printf("Memory: internal %u free, %u largest, %u min ever\n",
+                  (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+                  (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+                  (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+}
+
+static void printCapability(const char* name, uint32_t caps) {
+    size_t total = heap_caps_get_total_size(caps);
+    if (total == 0) {
+        Serial.printf("%-9s not present\n", name);
+        return;
+    }
+    Serial.printf("%-9s total %7u  free %7u  largest %7u  min ever %7u\n", name,
+                  (unsigned)total,
+                  (unsigned)heap_caps_get_free_size(caps),
+                  (unsigned)heap_caps_get_largest_free_block(caps),
+                  (unsigned)heap_caps_get_minimum_free_size(caps));
+}
+
+void memoryDumpReport() {
+    Serial.println("\n--- Memory ---");
+    printCapability("internal", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    printCapability("dma", MALLOC_CAP_DMA);
+    printCapability("psram", MALLOC_CAP_SPIRAM);
+
+    for (int i = 0; i < MEM_SPAN_COUNT; i++) {
+        const MemSpanStats& st = spans[i];
+        if (st.count == 0) continue;
+        Serial.printf("%-12s n=%-4u low %7u  largest %7u  held %+6d  stack left %5u"
+                      "  dma low %7u  psram low %8u\n",
+                      SPAN_NAMES[i], (unsigned)st.count, (unsigned)st.lowestFree,
+                      (unsigned)st.lowestLargest, (int)st.worstDelta,
+                      (unsigned)st.lowestStack, (unsigned)st.lowestDma,
+                      (unsigned)st.lowestPsram);
+    }
+
+    for (int i = 0; i < watchedCount; i++) {
+        Serial.printf("task %-7s stack left %5u\n", pcTaskGetTaskName(watchedTasks[i]),
+                      (unsigned)uxTaskGetStackHighWaterMark(watchedTasks[i]));
+    }
+}
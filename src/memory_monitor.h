@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// ========================================
+// Memory Monitor
+// ========================================
+// Heap and stack watermarks around the allocation-heavy steps. Each span
+// samples internal/DMA/PSRAM free bytes and the largest free internal
+// block on entry and exit, plus the running task's stack high-water mark,
+// and keeps the worst values seen (the lowest free bytes for each heap).
+// memoryDumpReport() prints them with the SDK's minimum-ever free size
+// per capability and every registered task's stack headroom.
+//
+// The delta of a span is the memory it still held on exit (a leak, or
+// data handed on); the low-water mark is the peak it needed. Use them to
+// size LVGL_DRAW_BUF_SIZE and the JsonDocuments. A largest block that
+// keeps shrinking while free memory doesn't is fragmentation.
+
+enum MemSpan : uint8_t {
+    MEM_SPAN_GEOLOCATION,
+    MEM_SPAN_HTTP_BODY,     // End of headers until the body is drained
+    MEM_SPAN_JSON_PARSE,    // Includes the JsonDocument's pool growth
+    MEM_SPAN_RENDER,        // Label update plus LVGL draw and flush
+    MEM_SPAN_COUNT
+};
+
+#define MEMORY_MAX_TASKS 4
+
+// Each span must be entered and left by the same task, not nested with itself
+void memoryEnter(MemSpan span);
+void memoryLeave(MemSpan span);
+
+// Include a task in the stack section of the report
+void memoryWatchTask(TaskHandle_t task);
+
+// One line: free, largest block and minimum-ever internal heap
+void memoryLogSummary();
+
+// Full table to Serial
+void memoryDumpReport();
+
+// Enters and leaves a span with the scope
+class MemoryScope {
+public:
+    explicit MemoryScope(MemSpan span) : span(span) { memoryEnter(span); }
+    ~MemoryScope() { memoryLeave(span); }
+
+private:
+    MemSpan span;
+};
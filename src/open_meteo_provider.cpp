@@ -0,0 +1,149 @@
+#include "open_meteo_provider.h"
+
+#include "deferred_log.h"
+#include "forecast_aggregator.h"
+#include "text_format.h"
+
+struct WmoCode {
+    uint8_t code;
+    const char* description;
+};
+
+// WMO 4677 codes as used by Open-Meteo, worded like OWM's descriptions
+static const WmoCode WMO_CODES[] = {
+    {0, "clear sky"},
+    {1, "mainly clear"},
+    {2, "partly cloudy"},
+    {3, "overcast clouds"},
+    {45, "fog"},
+    {48, "freezing fog"},
+    {51, "light drizzle"},
+    {53, "drizzle"},
+    {55, "heavy drizzle"},
+    {56, "light freezing drizzle"},
+    {57, "freezing drizzle"},
+    {61, "light rain"},
+    {63, "moderate rain"},
+    {65, "heavy rain"},
+    {66, "light freezing rain"},
+    {67, "freezing rain"},
+    {71, "light snow"},
+    {73, "snow"},
+    {75, "heavy snow"},
+    {77, "snow grains"},
+    {80, "light rain showers"},
+    {81, "rain showers"},
+    {82, "heavy rain showers"},
+    {85, "light snow showers"},
+    {86, "heavy snow showers"},
+    {95, "thunderstorm"},
+    {96, "thunderstorm with hail"},
+    {99, "thunderstorm with heavy hail"},
+};
+
+const char* wmoDescription(int code) {
+    for (const WmoCode& entry : WMO_CODES) {
+        if (entry.code == code) return entry.description;
+    }
+    return "";
+}
+
+bool OpenMeteoProvider::sendRequests(HttpSession& session, const Location& location) {
+    char path[HTTP_PATH_MAX];
+    snprintf(path, sizeof(path),
+             "/v1/forecast?latitude=%.4f&longitude=%.4f"
+             "&current=temperature_2m,weather_code"
+             "&hourly=temperature_2m,relative_humidity_2m,weather_code"
+             "&daily=weather_code,temperature_2m_max,temperature_2m_min"
+             "&temperature_unit=%s&timezone=auto&timeformat=unixtime&forecast_days=3",
+             location.latitude, location.longitude,
+             strcmp(units, "imperial") == 0 ? "fahrenheit" : "celsius");
+
+    LOG_INFO("Fetching Open-Meteo forecast...\n");
+    return session.sendGet(path);
+}
+
+bool OpenMeteoProvider::readResponses(HttpSession& session, WeatherReport& report) {
+    if (!expectOk(session, "forecast")) return false;
+
+    // Whole arrays are kept; the units blocks, elevation etc. are not
+    JsonDocument filter(&arena);
+    filter["utc_offset_seconds"] = true;
+    filter["current"]["temperature_2m"] = true;
+    filter["current"]["weather_code"] = true;
+    filter["hourly"]["time"] = true;
+    filter["hourly"]["temperature_2m"] = true;
+    filter["hourly"]["relative_humidity_2m"] = true;
+    filter["hourly"]["weather_code"] = true;
+    filter["daily"]["time"] = true;
+    filter["daily"]["weather_code"] = true;
+    filter["daily"]["temperature_2m_max"] = true;
+    filter["daily"]["temperature_2m_min"] = true;
+
+    JsonDocument doc(&arena);
+    if (parse(session, doc, filter, "forecast")) return false;
+    arena.logUsage("weather fetch");
+
+    report.utcOffset = doc["utc_offset_seconds"].as<int32_t>();
+    report.currentTemp = tenthsFromFloat(doc["current"]["temperature_2m"].as<float>());
+    strlcpy(report.currentCondition, wmoDescription(doc["current"]["weather_code"] | -1),
+            sizeof(report.currentCondition));
+    LOG_INFO("Open-Meteo current: %.1f, %s (UTC offset %d s)\n", report.currentTemp / 10.0f,
+             report.currentCondition, (int)report.utcOffset);
+
+    // Parallel arrays, walked together (indexing a JsonArray is linear)
+    JsonObject hourly = doc["hourly"];
+    size_t hours = hourly["time"].size();
+    if (hourly["temperature_2m"].size() != hours ||
+        hourly["relative_humidity_2m"].size() != hours || hourly["weather_code"].size() != hours) {
+        LOG_ERROR("Open-Meteo hourly arrays differ in length\n");
+        return false;
+    }
+    JsonArray::iterator temp = hourly["temperature_2m"].as<JsonArray>().begin();
+    JsonArray::iterator humidity = hourly["relative_humidity_2m"].as<JsonArray>().begin();
+    JsonArray::iterator code = hourly["weather_code"].as<JsonArray>().begin();
+    for (JsonVariant stamp : hourly["time"].as<JsonArray>()) {
+        if (report.hourlyCount == WEATHER_HOURLY_MAX) break;
+        // Hours the model has no value for come as null; skip them
+        if (!temp->isNull()) {
+            HourlyPoint& point = report.hourly[report.hourlyCount++];
+            point.dt = stamp.as<long>();
+            point.temp = tenthsFromFloat(temp->as<float>());
+            point.humidity = humidity->as<uint8_t>();
+            strlcpy(point.description, wmoDescription(*code | -1), sizeof(point.description));
+        }
+        ++temp;
+        ++humidity;
+        ++code;
+    }
+
+    // Daily times are the local midnights, as UTC timestamps. utcOffset is
+    // the offset now; across a DST change in the window it is an hour off
+    // for the later days, which would put their midnight on the day
+    // before. Midday is on the right day either way.
+    JsonObject daily = doc["daily"];
+    size_t days = daily["time"].size();
+    if (daily["temperature_2m_max"].size() != days ||
+        daily["temperature_2m_min"].size() != days || daily["weather_code"].size() != days) {
+        LOG_ERROR("Open-Meteo daily arrays differ in length\n");
+        return false;
+    }
+    JsonArray::iterator high = daily["temperature_2m_max"].as<JsonArray>().begin();
+    JsonArray::iterator low = daily["temperature_2m_min"].as<JsonArray>().begin();
+    JsonArray::iterator dayCode = daily["weather_code"].as<JsonArray>().begin();
+    for (JsonVariant stamp : daily["time"].as<JsonArray>()) {
+        if (report.dailyCount == WEATHER_DAILY_MAX) break;
+        if (!high->isNull() && !low->isNull()) {
+            DailyPoint& day = report.daily[report.dailyCount++];
+            day.dayNumber = dayNumberFromEpoch(stamp.as<long>() + (int64_t)report.utcOffset +
+                                               12 * 3600);
+            day.tempHigh = tenthsFromFloat(high->as<float>());
+            day.tempLow = tenthsFromFloat(low->as<float>());
+            strlcpy(day.description, wmoDescription(*dayCode | -1), sizeof(day.description));
+        }
+        ++high;
+        ++low;
+        ++dayCode;
+    }
+    return true;
+}
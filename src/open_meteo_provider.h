@@ -0,0 +1,37 @@
+#pragma once
+
+#include "refresh_scheduler.h"
+#include "weather_provider.h"
+
+// ========================================
+// Open-Meteo Backend
+// ========================================
+// One key-free request to /v1/forecast returns current conditions, 72
+// hourly points and 3 daily aggregates as parallel arrays, already in
+// the requested unit and with the location's UTC offset (timezone=auto).
+// Times are asked for as Unix timestamps so nothing needs date parsing.
+// Conditions come as WMO weather codes and are mapped to OWM-style
+// descriptions. There is no place name; the report's city stays empty.
+
+class OpenMeteoProvider : public WeatherProvider {
+public:
+    // units as for OWM: "imperial" asks for Fahrenheit, anything else Celsius
+    OpenMeteoProvider(const char* host, uint16_t port, TlsChannel* tls, JsonArena& arena,
+                      const char* units)
+        : WeatherProvider(host, port, tls, arena), units(units) {}
+
+    const char* name() const override { return "Open-Meteo"; }
+    uint8_t id() const override { return WEATHER_PROVIDER_OPEN_METEO; }
+    uint8_t callsPerFetch() const override { return 1; }
+    uint16_t dailyCallLimit() const override { return OPEN_METEO_DAILY_CALL_LIMIT; }
+
+protected:
+    bool sendRequests(HttpSession& session, const Location& location) override;
+    bool readResponses(HttpSession& session, WeatherReport& report) override;
+
+private:
+    const char* units;
+};
+
+// Lowercase description for a WMO weather interpretation code
+const char* wmoDescription(int code);
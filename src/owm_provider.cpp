@@ -0,0 +1,76 @@
+#include "owm_provider.h"
+
+#include "deferred_log.h"
+#include "text_format.h"
+
+bool OwmProvider::sendRequests(HttpSession& session, const Location& location) {
+    // The forecast request is written before the current weather response
+    // is read, saving a round trip
+    char currentPath[HTTP_PATH_MAX];
+    snprintf(currentPath, sizeof(currentPath),
+             "/data/2.5/weather?lat=%.6f&lon=%.6f&appid=%s&units=%s",
+             location.latitude, location.longitude, apiKey, units);
+
+    char forecastPath[HTTP_PATH_MAX];
+    snprintf(forecastPath, sizeof(forecastPath),
+             "/data/2.5/forecast?lat=%.6f&lon=%.6f&appid=%s&units=%s&cnt=40",  // Get 5 days worth
+             location.latitude, location.longitude, apiKey, units);
+
+    LOG_INFO("Fetching current weather and forecast...\n");
+    return session.sendGet(currentPath) && session.sendGet(forecastPath);
+}
+
+bool OwmProvider::readResponses(HttpSession& session, WeatherReport& report) {
+    if (!expectOk(session, "weather")) return false;
+
+    // Only keep the fields we display, parsed directly from the socket
+    JsonDocument currentFilter(&arena);
+    currentFilter["name"] = true;
+    currentFilter["weather"][0]["description"] = true;
+
+    JsonDocument currentDoc(&arena);
+    if (parse(session, currentDoc, currentFilter, "weather")) return false;
+
+    strlcpy(report.city, currentDoc["name"] | "", sizeof(report.city));
+    strlcpy(report.currentCondition, currentDoc["weather"][0]["description"] | "",
+            sizeof(report.currentCondition));
+    LOG_INFO("Current Weather API conditions: %s\n", report.currentCondition);
+
+    if (!expectOk(session, "forecast")) return false;
+
+    // Stream the ~15-20 KB forecast body through a filter instead of
+    // buffering it; only the fields of the hourly series are kept. The
+    // first element of a filter array applies to every list entry.
+    JsonDocument filter(&arena);
+    filter["city"]["timezone"] = true;
+    JsonObject entryFilter = filter["list"].add<JsonObject>();
+    entryFilter["dt"] = true;
+    entryFilter["main"]["temp"] = true;
+    entryFilter["main"]["humidity"] = true;
+    entryFilter["weather"][0]["description"] = true;
+
+    JsonDocument doc(&arena);
+    if (parse(session, doc, filter, "forecast")) return false;
+    arena.logUsage("weather fetch");
+
+    // Timezone offset from the API (seconds from UTC)
+    report.utcOffset = doc["city"]["timezone"].as<int32_t>();
+    LOG_INFO("Timezone offset from API: %d seconds (%d hours)\n", (int)report.utcOffset,
+             (int)(report.utcOffset / 3600));
+
+    for (JsonObject item : doc["list"].as<JsonArray>()) {
+        if (report.hourlyCount == WEATHER_HOURLY_MAX) break;
+        HourlyPoint& point = report.hourly[report.hourlyCount++];
+        point.dt = item["dt"].as<long>();
+        point.temp = tenthsFromFloat(item["main"]["temp"].as<float>());
+        point.humidity = item["main"]["humidity"].as<uint8_t>();
+        strlcpy(point.description, item["weather"][0]["description"] | "",
+                sizeof(point.description));
+    }
+
+    if (report.hourlyCount > 0) {
+        report.currentTemp = report.hourly[0].temp;
+        LOG_INFO("First Forecast Entry: %.1fF\n", report.currentTemp / 10.0f);
+    }
+    return true;
+}
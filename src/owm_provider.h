@@ -0,0 +1,34 @@
+#pragma once
+
+#include "refresh_scheduler.h"
+#include "weather_provider.h"
+
+// ========================================
+// OpenWeatherMap Backend
+// ========================================
+// Two pipelined requests on one connection: /data/2.5/weather for the
+// place name and current conditions, /data/2.5/forecast for 40
+// three-hourly entries. The first forecast entry stands in for the
+// current temperature (more reliable than the nearest station for small
+// towns). OWM doesn't aggregate days, so the report has no daily points.
+
+class OwmProvider : public WeatherProvider {
+public:
+    // apiKey and units ("imperial"/"metric") must stay valid
+    OwmProvider(const char* host, uint16_t port, TlsChannel* tls, JsonArena& arena,
+                const char* apiKey, const char* units)
+        : WeatherProvider(host, port, tls, arena), apiKey(apiKey), units(units) {}
+
+    const char* name() const override { return "OWM"; }
+    uint8_t id() const override { return WEATHER_PROVIDER_OWM; }
+    uint8_t callsPerFetch() const override { return 2; }
+    uint16_t dailyCallLimit() const override { return OWM_DAILY_CALL_LIMIT; }
+
+protected:
+    bool sendRequests(HttpSession& session, const Location& location) override;
+    bool readResponses(HttpSession& session, WeatherReport& report) override;
+
+private:
+    const char* apiKey;
+    const char* units;
+};
@@ -0,0 +1,90 @@
+#include "phase_timer.h"
+
+#include "Arduino.h"
+
+struct PhaseHistogram {
+    uint16_t buckets[PHASE_BUCKETS];  // Saturating counts
+    uint32_t count;
+    uint32_t max;
+    uint32_t timeouts;
+};
+
+static PhaseHistogram histograms[PHASE_COUNT];
+
+static const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "wifi connect", "wifi scan", "geolocation", "ntp sync",
+    "dns", "http connect", "tls full", "tls resumed", "http ttfb", "http body",
+    "json parse", "aggregation", "ui update", "lvgl flush",
+};
+
+// 0-3 map to themselves; above that the top three significant bits pick
+// one of four sub-buckets within the value's octave
+static int bucketFor(uint32_t us) {
+    if (us < 4) return us;
+    int octave = 31 - __builtin_clz(us);  // >= 2
+    int sub = (us >> (octave - 2)) & 3;
+    return 4 * (octave - 1) + sub;
+}
+
+// Middle of a bucket's range, used as its representative value
+static uint32_t bucketValue(int index) {
+    if (index < 4) return index;
+    int octave = index / 4 + 1;
+    uint64_t low = (uint64_t)(4 + index % 4) << (octave - 2);
+    uint64_t width = 1ULL << (octave - 2);
+    return (uint32_t)(low + width / 2);
+}
+
+void phaseRecord(Phase phase, uint32_t micros) {
+    PhaseHistogram& h = histograms[phase];
+    uint16_t& bucket = h.buckets[bucketFor(micros)];
+    if (bucket < UINT16_MAX) bucket++;
+    h.count++;
+    if (micros > h.max) h.max = micros;
+}
+
+void phaseRecordTimeout(Phase phase) {
+    histograms[phase].timeouts++;
+}
+
+const char* phaseName(Phase phase) {
+    return phase < PHASE_COUNT ? PHASE_NAMES[phase] : "?";
+}
+
+// Smallest bucket value with at least the given share of samples below it
+static uint32_t percentile(const PhaseHistogram& h, uint32_t total, float share) {
+    uint32_t rank = (uint32_t)(share * total + 0.999f);
+    uint32_t seen = 0;
+    for (int i = 0; i < PHASE_BUCKETS; i++) {
+        seen += h.buckets[i];
+        if (seen >= rank) return bucketValue(i);
+    }
+    return h.max;
+}
+
+static void printDuration(const char* label, uint32_t us) {
+    if (us >= 10000) {
+        Serial.printf(" %s %7.1f ms", label, us / 1000.0f);
+    } else {
+        Serial.printf(" %s %7u us", label, (unsigned)us);
+    }
+}
+
+void phaseDumpReport() {
+    Serial.println("\n--- Phase timings ---");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        const PhaseHistogram& h = histograms[p];
+        if (h.count == 0 && h.timeouts == 0) continue;
+
+        // Bucket counts saturate, so rank against what the buckets hold
+        uint32_t total = 0;
+        for (int i = 0; i < PHASE_BUCKETS; i++) total += h.buckets[i];
+
+        Serial.printf("%-13s n=%-6u", PHASE_NAMES[p], (unsigned)h.count);
+        printDuration("p50", percentile(h, total, 0.50f));
+        printDuration("p95", percentile(h, total, 0.95f));
+        printDuration("max", h.max);
+        if (h.timeouts) Serial.printf("  timeouts %u", (unsigned)h.timeouts);
+        Serial.println();
+    }
+}
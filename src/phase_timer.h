@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include "esp_timer.h"
+
+// ========================================
+// Phase Timing Histograms
+// ========================================
+// Durations of the refresh and render phases go into fixed-bucket
+// histograms in RAM (no allocation, no logging on the hot path). Buckets
+// are log-linear: four per power of two, so percentiles are within ~12%.
+// phaseDumpReport() prints count, p50, p95 and max for every phase, and
+// how often each one ran out of its time budget (see request_budget.h).
+//
+// Each phase must be recorded from one context only (a task or the LCD
+// ISR). Response bodies are streamed into the JSON parser, so BODY and
+// JSON overlap: JSON is the deserializeJson() call, BODY runs from the
+// end of the headers until the response is fully drained.
+
+enum Phase : uint8_t {
+    PHASE_WIFI_CONNECT,
+    PHASE_WIFI_SCAN,
+    PHASE_GEOLOCATION,
+    PHASE_NTP_SYNC,
+    PHASE_DNS,
+    PHASE_HTTP_CONNECT,
+    PHASE_TLS_FULL,     // Handshake with certificate exchange
+    PHASE_TLS_RESUMED,  // Abbreviated handshake from a saved session
+    PHASE_HTTP_TTFB,
+    PHASE_HTTP_BODY,
+    PHASE_JSON_PARSE,
+    PHASE_AGGREGATION,
+    PHASE_UI_UPDATE,
+    PHASE_LVGL_FLUSH,   // flush_cb to DMA-complete, per band
+    PHASE_COUNT
+};
+
+#define PHASE_BUCKETS 124   // 0-3 us exact, then 4 per octave up to 2^32 us
+
+// Add one sample
+void phaseRecord(Phase phase, uint32_t micros);
+
+// Count a phase that was cut short by its deadline
+void phaseRecordTimeout(Phase phase);
+
+// Short lowercase name, e.g. "http ttfb"
+const char* phaseName(Phase phase);
+
+// Print the table to Serial
+void phaseDumpReport();
+
+// Records the lifetime of the scope
+class PhaseTimer {
+public:
+    explicit PhaseTimer(Phase phase) : phase(phase), start(esp_timer_get_time()) {}
+    ~PhaseTimer() { phaseRecord(phase, (uint32_t)(esp_timer_get_time() - start)); }
+
+private:
+    Phase phase;
+    int64_t start;
+};
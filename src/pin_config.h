@@ -9,11 +9,22 @@
 #define NTP_SERVER2                  "time.nist.gov"
 #define GMT_OFFSET_SEC               0
 #define DAY_LIGHT_OFFSET_SEC         0
-// if CUSTOM_TIMEZONE is not defined then TIMEZONE API used based on IP, check zones.h
+// Local zone for DST rules, check zones.h
 // #define CUSTOM_TIMEZONE             "Europe/London"
 
-/* Automatically update local time */
-#define GET_TIMEZONE_API             "https://ipapi.co/timezone/"
+/* Without CUSTOM_TIMEZONE, TIMEZONE_IP_LOOKUP 1 asks the TIMEZONE API for
+   the zone of our public IP. Plain HTTP: it reveals the IP and the answer
+   isn't authenticated. Off: the forecast API's fixed offset is used. */
+#ifndef TIMEZONE_IP_LOOKUP
+#define TIMEZONE_IP_LOOKUP           0
+#endif
+#ifndef TIMEZONE_API_HOST
+#define TIMEZONE_API_HOST            "ip-api.com"
+#endif
+#ifndef TIMEZONE_API_PORT
+#define TIMEZONE_API_PORT            80
+#endif
+#define TIMEZONE_API_PATH            "/line/?fields=timezone"
 
 /* LCD CONFIG */
 // Too low or too high pixel clock may cause screen mosaic
@@ -22,6 +33,20 @@
 #define EXAMPLE_LCD_H_RES            320
 #define EXAMPLE_LCD_V_RES            170
 #define LVGL_LCD_BUF_SIZE            (EXAMPLE_LCD_H_RES * EXAMPLE_LCD_V_RES)
+// LVGL draw buffer mode:
+//   1 = two partial DMA buffers (ping-pong), LVGL renders into one while
+//       the other is being sent over the i80 bus
+//   0 = one full-frame buffer, rendering waits for each transfer
+// Override with -D LVGL_DOUBLE_BUFFER=0 in platformio.ini to compare modes
+#ifndef LVGL_DOUBLE_BUFFER
+#define LVGL_DOUBLE_BUFFER           1
+#endif
+#define LVGL_PARTIAL_BUF_LINES       (EXAMPLE_LCD_V_RES / 10)
+#if LVGL_DOUBLE_BUFFER
+#define LVGL_DRAW_BUF_SIZE           (EXAMPLE_LCD_H_RES * LVGL_PARTIAL_BUF_LINES)
+#else
+#define LVGL_DRAW_BUF_SIZE           LVGL_LCD_BUF_SIZE
+#endif
 #define EXAMPLE_PSRAM_DATA_ALIGNMENT 64
 
 /*ESP32S3*/
@@ -0,0 +1,236 @@
+#include "posix_tz.h"
+
+#include <ctype.h>
+
+static const int32_t SECONDS_PER_DAY = 86400;
+
+// ----------------------------------------
+// Calendar helpers (proleptic Gregorian, integer only)
+// ----------------------------------------
+
+static int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b < 0) ? q - 1 : q;
+}
+
+// Howard Hinnant's days_from_civil: days since 1970-01-01
+static int64_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    uint32_t yoe = (uint32_t)(y - era * 400);
+    uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (int64_t)era * 146097 + (int64_t)doe - 719468;
+}
+
+static int32_t yearFromDays(int64_t days) {
+    int64_t z = days + 719468;
+    int64_t era = floorDiv(z, 146097);
+    uint32_t doe = (uint32_t)(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    return (int32_t)(yoe + era * 400) + (mp >= 10);
+}
+
+static bool isLeapYear(int32_t y) {
+    return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+}
+
+static int daysInMonth(int32_t y, int m) {
+    static const uint8_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return (m == 2 && isLeapYear(y)) ? 29 : days[m - 1];
+}
+
+static int weekdayFromDays(int64_t days) {
+    return (int)(((days + 4) % 7 + 7) % 7);  // 1970-01-01 was a Thursday
+}
+
+// ----------------------------------------
+// Parser
+// ----------------------------------------
+
+// Zone abbreviation: 3+ letters, or anything inside <...>
+static const char* parseName(const char* p) {
+    if (*p == '<') {
+        p++;
+        while (*p && *p != '>') p++;
+        return *p == '>' ? p + 1 : nullptr;
+    }
+    const char* start = p;
+    while (isalpha((unsigned char)*p)) p++;
+    return (p - start >= 3) ? p : nullptr;
+}
+
+static const char* parseNumber(const char* p, int32_t& value) {
+    if (!isdigit((unsigned char)*p)) return nullptr;
+    value = 0;
+    while (isdigit((unsigned char)*p)) {
+        value = value * 10 + (*p++ - '0');
+        if (value > 100000) return nullptr;
+    }
+    return p;
+}
+
+// [+|-]hh[:mm[:ss]] in seconds
+static const char* parseTime(const char* p, int32_t& seconds) {
+    int32_t sign = 1;
+    if (*p == '+' || *p == '-') {
+        if (*p == '-') sign = -1;
+        p++;
+    }
+    int32_t h = 0, m = 0, s = 0;
+    p = parseNumber(p, h);
+    if (p && *p == ':') {
+        p = parseNumber(p + 1, m);
+        if (p && *p == ':') p = parseNumber(p + 1, s);
+    }
+    if (!p || h > 167 || m > 59 || s > 59) return nullptr;
+    seconds = sign * (h * 3600 + m * 60 + s);
+    return p;
+}
+
+static const char* parseRule(const char* p, PosixTzRule& rule) {
+    int32_t a = 0, b = 0, c = 0;
+    if (*p == 'M') {
+        p = parseNumber(p + 1, a);
+        if (!p || *p != '.') return nullptr;
+        p = parseNumber(p + 1, b);
+        if (!p || *p != '.') return nullptr;
+        p = parseNumber(p + 1, c);
+        if (!p || a < 1 || a > 12 || b < 1 || b > 5 || c > 6) return nullptr;
+        rule.kind = PosixTzRule::MONTH_WEEK_DAY;
+        rule.month = a;
+        rule.week = b;
+        rule.weekday = c;
+    } else if (*p == 'J') {
+        p = parseNumber(p + 1, a);
+        if (!p || a < 1 || a > 365) return nullptr;
+        rule.kind = PosixTzRule::JULIAN_NO_LEAP;
+        rule.day = a;
+    } else {
+        p = parseNumber(p, a);
+        if (!p || a > 365) return nullptr;
+        rule.kind = PosixTzRule::ZERO_BASED_DAY;
+        rule.day = a;
+    }
+
+    rule.time = 2 * 3600;  // Default 02:00
+    if (*p == '/') {
+        p = parseTime(p + 1, rule.time);
+    }
+    return p;
+}
+
+bool parsePosixTz(const char* spec, PosixTz& out) {
+    int32_t offset = 0;
+    const char* p = parseName(spec);
+    if (p) p = parseTime(p, offset);
+    if (!p) return false;
+
+    // POSIX offsets are west-positive; store east-positive
+    out.stdOffset = -offset;
+    out.dstOffset = out.stdOffset;
+    out.hasDst = false;
+    if (*p == '\0') return true;
+
+    p = parseName(p);
+    if (!p) return false;
+    out.hasDst = true;
+    out.dstOffset = out.stdOffset + 3600;
+    if (*p != '\0' && *p != ',') {
+        p = parseTime(p, offset);
+        if (!p) return false;
+        out.dstOffset = -offset;
+    }
+
+    if (*p == '\0') {
+        // No rules given: same US default as glibc
+        return parseRule("M3.2.0", out.start) && parseRule("M11.1.0", out.end);
+    }
+
+    if (*p != ',') return false;
+    p = parseRule(p + 1, out.start);
+    if (!p || *p != ',') return false;
+    p = parseRule(p + 1, out.end);
+    return p && *p == '\0';
+}
+
+// ----------------------------------------
+// Transitions
+// ----------------------------------------
+
+int64_t posixTzTransition(const PosixTzRule& rule, int32_t year, int32_t offsetBefore) {
+    int64_t day;
+    switch (rule.kind) {
+        case PosixTzRule::MONTH_WEEK_DAY: {
+            int64_t first = daysFromCivil(year, rule.month, 1);
+            int dom = 1 + (rule.weekday - weekdayFromDays(first) + 7) % 7 + (rule.week - 1) * 7;
+            while (dom > daysInMonth(year, rule.month)) dom -= 7;  // Week 5 = last
+            day = first + dom - 1;
+            break;
+        }
+        case PosixTzRule::JULIAN_NO_LEAP:
+            // Feb 29 is never counted, so J60 is always March 1
+            day = daysFromCivil(year, 1, 1) + rule.day - 1;
+            if (isLeapYear(year) && rule.day >= 60) day++;
+            break;
+        default:
+            day = daysFromCivil(year, 1, 1) + rule.day;
+            break;
+    }
+    return day * SECONDS_PER_DAY + rule.time - offsetBefore;
+}
+
+void TzTransitionCache::buildFixed(int32_t offset) {
+    initialOffset = offset;
+    count = 0;
+    hint = 0;
+}
+
+void TzTransitionCache::build(const PosixTz& tz, int64_t fromUtc, int64_t toUtc) {
+    if (!tz.hasDst) {
+        buildFixed(tz.stdOffset);
+        return;
+    }
+
+    // One year of margin on each side catches transitions whose local
+    // rule date falls in a neighbouring year
+    int32_t firstYear = yearFromDays(floorDiv(fromUtc, SECONDS_PER_DAY)) - 1;
+    int32_t lastYear = yearFromDays(floorDiv(toUtc, SECONDS_PER_DAY)) + 1;
+    if (lastYear - firstYear + 1 > MAX_TRANSITIONS / 2) {
+        lastYear = firstYear + MAX_TRANSITIONS / 2 - 1;
+    }
+
+    count = 0;
+    hint = 0;
+    for (int32_t y = firstYear; y <= lastYear; y++) {
+        instants[count] = posixTzTransition(tz.start, y, tz.stdOffset);
+        offsetsAfter[count++] = tz.dstOffset;
+        instants[count] = posixTzTransition(tz.end, y, tz.dstOffset);
+        offsetsAfter[count++] = tz.stdOffset;
+    }
+
+    // Insertion sort; southern-hemisphere zones end DST before starting it
+    for (int i = 1; i < count; i++) {
+        int64_t at = instants[i];
+        int32_t off = offsetsAfter[i];
+        int j = i - 1;
+        while (j >= 0 && instants[j] > at) {
+            instants[j + 1] = instants[j];
+            offsetsAfter[j + 1] = offsetsAfter[j];
+            j--;
+        }
+        instants[j + 1] = at;
+        offsetsAfter[j + 1] = off;
+    }
+
+    initialOffset = (offsetsAfter[0] == tz.dstOffset) ? tz.stdOffset : tz.dstOffset;
+}
+
+int32_t TzTransitionCache::offsetAt(int64_t utc) {
+    // hint = number of transitions at or before utc
+    while (hint < count && instants[hint] <= utc) hint++;
+    while (hint > 0 && instants[hint - 1] > utc) hint--;
+    return hint == 0 ? initialOffset : offsetsAfter[hint - 1];
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+
+// ========================================
+// POSIX TZ Rule Engine
+// ========================================
+// Parses POSIX TZ strings such as "CST6CDT,M3.2.0,M11.1.0" (the format
+// used in zones.h) and converts UTC instants to local UTC offsets without
+// touching the libc TZ environment. Transitions for a time window are
+// computed once, after which each lookup is a cached index walk.
+// Plain C++ only; nothing here depends on Arduino.
+
+// One DST start/end rule: "Mm.w.d", "Jn" or "n", plus a local time of day
+struct PosixTzRule {
+    enum Kind : uint8_t { MONTH_WEEK_DAY, JULIAN_NO_LEAP, ZERO_BASED_DAY };
+    Kind kind;
+    uint8_t month;    // M: 1-12
+    uint8_t week;     // M: 1-5 (5 = last)
+    uint8_t weekday;  // M: 0 = Sunday
+    uint16_t day;     // J: 1-365, n: 0-365
+    int32_t time;     // Seconds after local midnight (may be negative or > 24h)
+};
+
+struct PosixTz {
+    int32_t stdOffset;   // Seconds EAST of UTC (local = UTC + offset)
+    int32_t dstOffset;
+    bool hasDst;
+    PosixTzRule start;   // Switch to DST (evaluated in standard time)
+    PosixTzRule end;     // Switch back (evaluated in daylight time)
+};
+
+// Parse a POSIX TZ string; returns false if it is malformed
+bool parsePosixTz(const char* spec, PosixTz& out);
+
+// UTC instant at which a rule fires in the given year, for the offset
+// in effect just before the transition
+int64_t posixTzTransition(const PosixTzRule& rule, int32_t year, int32_t offsetBefore);
+
+// Precomputed transitions covering a time window
+class TzTransitionCache {
+public:
+    // Compute all transitions affecting [fromUtc, toUtc]
+    void build(const PosixTz& tz, int64_t fromUtc, int64_t toUtc);
+
+    // A zone with a single fixed offset (no transitions)
+    void buildFixed(int32_t offset);
+
+    // UTC offset in seconds at the given instant. Lookups are fastest
+    // when instants are queried in increasing order.
+    int32_t offsetAt(int64_t utc);
+
+    int transitionCount() const { return count; }
+
+private:
+    static const int MAX_TRANSITIONS = 8;  // 2 per year, window + margin
+
+    int64_t instants[MAX_TRANSITIONS];
+    int32_t offsetsAfter[MAX_TRANSITIONS];
+    int32_t initialOffset = 0;
+    int count = 0;
+    int hint = 0;
+};
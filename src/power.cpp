@@ -0,0 +1,85 @@
+#include "power.h"
+
+#include "Arduino.h"
+#include "sdkconfig.h"
+#include "esp_timer.h"
+#if CONFIG_PM_ENABLE
+#include "esp_pm.h"
+#endif
+
+static const char* const LOCK_NAMES[POWER_LOCK_COUNT] = {"network", "render"};
+
+#if CONFIG_PM_ENABLE
+static esp_pm_lock_handle_t pmLocks[POWER_LOCK_COUNT];
+#endif
+
+// Busy time per lock in microseconds; written only by the owning task.
+// 32-bit so reads are atomic; deltas survive the ~71 minute wrap.
+static volatile uint32_t busyUs[POWER_LOCK_COUNT];
+static uint32_t acquiredAt[POWER_LOCK_COUNT];
+
+// Reader state for powerLogStats()
+static uint32_t lastBusyUs[POWER_LOCK_COUNT];
+static uint32_t lastStatsUs = 0;
+
+void powerInit() {
+    lastStatsUs = (uint32_t)esp_timer_get_time();
+
+#if CONFIG_PM_ENABLE
+    for (int i = 0; i < POWER_LOCK_COUNT; i++) {
+        esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, LOCK_NAMES[i], &pmLocks[i]);
+    }
+
+    esp_pm_config_esp32s3_t config = {};
+    config.max_freq_mhz = POWER_MAX_FREQ_MHZ;
+    config.min_freq_mhz = POWER_MIN_FREQ_MHZ;
+    config.light_sleep_enable = POWER_LIGHT_SLEEP;
+    esp_err_t err = esp_pm_configure(&config);
+    if (err == ESP_ERR_NOT_SUPPORTED && config.light_sleep_enable) {
+        // Light sleep needs CONFIG_FREERTOS_USE_TICKLESS_IDLE; keep DFS
+        config.light_sleep_enable = false;
+        err = esp_pm_configure(&config);
+    }
+    if (err == ESP_OK) {
+        Serial.printf("✓ Power management: %d-%d MHz, light sleep %s\n",
+                      config.min_freq_mhz, config.max_freq_mhz,
+                      config.light_sleep_enable ? "on" : "off");
+    } else {
+        Serial.printf("✗ Power management unavailable (%s)\n", esp_err_to_name(err));
+    }
+#else
+    Serial.println("Power management not enabled in this SDK build");
+#endif
+}
+
+void powerAcquire(PowerLock lock) {
+#if CONFIG_PM_ENABLE
+    if (pmLocks[lock]) esp_pm_lock_acquire(pmLocks[lock]);
+#endif
+    acquiredAt[lock] = (uint32_t)esp_timer_get_time();
+}
+
+void powerRelease(PowerLock lock) {
+    busyUs[lock] += (uint32_t)esp_timer_get_time() - acquiredAt[lock];
+#if CONFIG_PM_ENABLE
+    if (pmLocks[lock]) esp_pm_lock_release(pmLocks[lock]);
+#endif
+}
+
+void powerLogStats(uint32_t uiWakeups) {
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    uint32_t elapsed = now - lastStatsUs;
+    if (elapsed == 0) return;
+
+    char line[128];
+    int len = snprintf(line, sizeof(line), "CPU busy:");
+    for (int i = 0; i < POWER_LOCK_COUNT; i++) {
+        uint32_t busy = busyUs[i];
+        len += snprintf(line + len, sizeof(line) - len, " %s %.2f%%", LOCK_NAMES[i],
+                        100.0f * (busy - lastBusyUs[i]) / elapsed);
+        lastBusyUs[i] = busy;
+    }
+    Serial.printf("%s, UI wakeups %.1f/s, %u MHz\n", line,
+                  uiWakeups * 1e6f / elapsed, (unsigned)getCpuFrequencyMhz());
+    lastStatsUs = now;
+}
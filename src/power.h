@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+
+// ========================================
+// Power Management
+// ========================================
+// Dynamic frequency scaling (and automatic light sleep when the SDK is
+// built with tickless idle) through esp_pm. The CPU idles at the minimum
+// frequency; tasks hold a lock only while they do network or render work,
+// which pins it to the maximum. Time spent holding each lock is counted
+// so the busy percentage can be logged.
+
+#ifndef POWER_MAX_FREQ_MHZ
+#define POWER_MAX_FREQ_MHZ     240
+#endif
+#ifndef POWER_MIN_FREQ_MHZ
+#define POWER_MIN_FREQ_MHZ     80   // Lowest that keeps APB (UART, LCD) at 80 MHz
+#endif
+#ifndef POWER_LIGHT_SLEEP
+#define POWER_LIGHT_SLEEP      1    // Ignored if the SDK lacks tickless idle
+#endif
+
+enum PowerLock : uint8_t {
+    POWER_LOCK_NETWORK,   // Includes time spent waiting on sockets
+    POWER_LOCK_RENDER,
+    POWER_LOCK_COUNT
+};
+
+// Configure esp_pm and create the locks; call once before starting tasks
+void powerInit();
+
+// Each lock must only be taken by one task, and not recursively
+void powerAcquire(PowerLock lock);
+void powerRelease(PowerLock lock);
+
+// Holds a lock for the lifetime of the scope
+class PowerLockScope {
+public:
+    explicit PowerLockScope(PowerLock lock) : lock(lock) { powerAcquire(lock); }
+    ~PowerLockScope() { powerRelease(lock); }
+
+private:
+    PowerLock lock;
+};
+
+// Log the busy percentage of each lock and the UI wakeup rate since the
+// previous call
+void powerLogStats(uint32_t uiWakeups);
@@ -0,0 +1,172 @@
+#include "refresh_scheduler.h"
+
+#include "Arduino.h"
+#include <time.h>
+#include "esp_system.h"
+#include "esp_sleep.h"
+#include "weather_provider.h"
+
+#define SCHEDULER_MAGIC 0x52534348  // "RSCH"
+#define CLOCK_VALID_AFTER 1600000000
+
+struct RetryPolicy {
+    uint32_t firstMs;
+    uint32_t maxMs;
+    uint16_t dailyLimit;   // 0 = not rate limited
+};
+
+static const RetryPolicy POLICIES[REFRESH_STEP_COUNT] = {
+    {RETRY_WIFI_FIRST_MS, RETRY_WIFI_MAX_MS, 0},
+    {RETRY_GEOLOCATION_FIRST_MS, RETRY_GEOLOCATION_MAX_MS, GEOLOCATION_DAILY_CALL_LIMIT},
+    {RETRY_WEATHER_FIRST_MS, RETRY_WEATHER_MAX_MS, 0},   // Limited per provider
+};
+
+static const char* const STEP_NAMES[REFRESH_STEP_COUNT] = {"WiFi", "geolocation", "weather"};
+
+// Survives deep sleep; reset on every cold boot
+struct SchedulerState {
+    uint32_t magic;
+    uint8_t failures[REFRESH_STEP_COUNT];     // Consecutive
+    uint16_t callsToday[REFRESH_STEP_COUNT];
+    uint16_t weatherCallsToday[WEATHER_PROVIDER_COUNT];
+    int32_t callDay;                          // UTC day number the counts are for
+};
+
+RTC_DATA_ATTR static SchedulerState rtcState;
+
+// millis() deadlines, only meaningful within one wake
+static uint32_t notBeforeMs[REFRESH_STEP_COUNT];
+static uint32_t nextRefreshAtMs = 0;
+
+// The weather step's provider was near its limit at its last fetch
+static bool weatherNearLimit = false;
+
+static bool reached(uint32_t deadlineMs) {
+    return (int32_t)(millis() - deadlineMs) >= 0;
+}
+
+static uint32_t msUntil(uint32_t deadlineMs) {
+    return reached(deadlineMs) ? 0 : deadlineMs - millis();
+}
+
+// Start a new count when the UTC day changes. Until the clock is set
+// the counts just accumulate (at worst a few boots' worth).
+static void rollCallDay() {
+    time_t now = time(nullptr);
+    if (now < CLOCK_VALID_AFTER) return;
+    int32_t day = (int32_t)(now / 86400);
+    if (day != rtcState.callDay) {
+        rtcState.callDay = day;
+        memset(rtcState.callsToday, 0, sizeof(rtcState.callsToday));
+        memset(rtcState.weatherCallsToday, 0, sizeof(rtcState.weatherCallsToday));
+    }
+}
+
+static uint32_t msUntilNextDay() {
+    time_t now = time(nullptr);
+    if (now < CLOCK_VALID_AFTER) return 60 * 60 * 1000;  // Check again in an hour
+    return (uint32_t)(86400 - now % 86400) * 1000;
+}
+
+static bool nearLimit(uint16_t calls, uint16_t dailyLimit) {
+    return dailyLimit && calls * 100 >= (uint32_t)dailyLimit * CALL_BUDGET_SLOWDOWN_PCT;
+}
+
+static void deferToNextDay(RefreshStep step, const char* what, uint16_t dailyLimit) {
+    uint32_t waitMs = msUntilNextDay();
+    notBeforeMs[step] = millis() + waitMs;
+    nextRefreshAtMs = notBeforeMs[step];
+    Serial.printf("✗ Daily %s call limit (%u) reached, next try in %lu min\n", what,
+                  (unsigned)dailyLimit, (unsigned long)(waitMs / 60000));
+}
+
+void schedulerInit() {
+    bool timerWake = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER;
+    if (!timerWake || rtcState.magic != SCHEDULER_MAGIC) {
+        memset(&rtcState, 0, sizeof(rtcState));
+        rtcState.magic = SCHEDULER_MAGIC;
+    }
+    memset(notBeforeMs, 0, sizeof(notBeforeMs));
+    nextRefreshAtMs = millis();
+    weatherNearLimit = false;
+}
+
+void schedulerSucceeded(RefreshStep step) {
+    rtcState.failures[step] = 0;
+    notBeforeMs[step] = millis();
+}
+
+void schedulerRefreshIn(uint32_t ms) {
+    nextRefreshAtMs = millis() + ms;
+}
+
+uint32_t schedulerFailed(RefreshStep step) {
+    const RetryPolicy& policy = POLICIES[step];
+    if (rtcState.failures[step] < UINT8_MAX) rtcState.failures[step]++;
+
+    // first, 2x, 4x ... up to the cap
+    uint32_t delayMs = policy.maxMs;
+    int doublings = rtcState.failures[step] - 1;
+    if (doublings < 16 && ((uint64_t)policy.firstMs << doublings) < policy.maxMs) {
+        delayMs = policy.firstMs << doublings;
+    }
+
+    // Running low on calls: stretch every retry to the maximum
+    rollCallDay();
+    bool lowOnCalls = step == REFRESH_STEP_WEATHER
+                          ? weatherNearLimit
+                          : nearLimit(rtcState.callsToday[step], policy.dailyLimit);
+    if (lowOnCalls) delayMs = policy.maxMs;
+
+    // Jitter over the upper half, so many stations failing together
+    // (an API outage) don't retry in lockstep
+    delayMs = delayMs / 2 + esp_random() % (delayMs / 2 + 1);
+
+    // Keep a later deferral (daily limit reached) rather than shorten it
+    if (msUntil(notBeforeMs[step]) > delayMs) {
+        delayMs = msUntil(notBeforeMs[step]);
+    }
+    notBeforeMs[step] = millis() + delayMs;
+    nextRefreshAtMs = notBeforeMs[step];
+    Serial.printf("Retry %s in %lu s (failure %u)\n", STEP_NAMES[step],
+                  (unsigned long)(delayMs / 1000), (unsigned)rtcState.failures[step]);
+    return delayMs;
+}
+
+bool schedulerStepReady(RefreshStep step) {
+    return reached(notBeforeMs[step]);
+}
+
+bool schedulerTakeCalls(RefreshStep step, uint16_t calls) {
+    const RetryPolicy& policy = POLICIES[step];
+    if (!policy.dailyLimit) return true;
+
+    rollCallDay();
+    if (rtcState.callsToday[step] + calls > policy.dailyLimit) {
+        deferToNextDay(step, STEP_NAMES[step], policy.dailyLimit);
+        return false;
+    }
+    rtcState.callsToday[step] += calls;
+    return true;
+}
+
+bool schedulerTakeWeatherCalls(const WeatherProvider& provider, bool deferStep) {
+    uint8_t id = provider.id();
+    if (id >= WEATHER_PROVIDER_COUNT) return true;
+    uint16_t dailyLimit = provider.dailyCallLimit();
+    uint16_t calls = provider.callsPerFetch();
+
+    rollCallDay();
+    uint16_t& used = rtcState.weatherCallsToday[id];
+    if (deferStep) weatherNearLimit = nearLimit(used, dailyLimit);
+    if (dailyLimit && used + calls > dailyLimit) {
+        if (deferStep) deferToNextDay(REFRESH_STEP_WEATHER, provider.name(), dailyLimit);
+        return false;
+    }
+    if (used <= UINT16_MAX - calls) used += calls;
+    return true;
+}
+
+uint32_t schedulerMsUntilRefresh() {
+    return msUntil(nextRefreshAtMs);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+
+// ========================================
+// Refresh Scheduler
+// ========================================
+// Decides when the network task runs its next refresh cycle. A good
+// fetch schedules the next one UPDATE_INTERVAL_MS later; a failure
+// schedules a retry with exponential backoff and jitter, with its own
+// policy per step (WiFi, geolocation, weather), starting at seconds and
+// capped at minutes. Geolocation failures don't block a refresh when a
+// location is already known; that step just sits out its backoff.
+//
+// API calls are counted per UTC day against the free-tier limits. Near
+// the limit, retries fall back to their longest delay; at the limit the
+// step waits for the next day. Weather calls are counted per provider,
+// each against its own limit, so key-free Open-Meteo requests (hedges
+// included) don't use up the OpenWeatherMap key's calls. Attempt counts
+// and call counts live in RTC memory, so deep-sleep wakes keep backing
+// off.
+
+enum RefreshStep : uint8_t {
+    REFRESH_STEP_WIFI,
+    REFRESH_STEP_GEOLOCATION,
+    REFRESH_STEP_WEATHER,
+    REFRESH_STEP_COUNT
+};
+
+// Retry delays (ms): first retry, and the ceiling it doubles up to
+#define RETRY_WIFI_FIRST_MS          5000
+#define RETRY_WIFI_MAX_MS            (5 * 60 * 1000)
+#define RETRY_GEOLOCATION_FIRST_MS   30000
+#define RETRY_GEOLOCATION_MAX_MS     (30 * 60 * 1000)
+#define RETRY_WEATHER_FIRST_MS       10000
+#define RETRY_WEATHER_MAX_MS         (10 * 60 * 1000)
+
+// Free-tier call limits per day
+#define OWM_DAILY_CALL_LIMIT         1000    // OpenWeatherMap, per API key
+#define OPEN_METEO_DAILY_CALL_LIMIT  10000   // Open-Meteo, non-commercial use
+#define GEOLOCATION_DAILY_CALL_LIMIT 1300    // Google: 40,000 per month
+#define CALL_BUDGET_SLOWDOWN_PCT     80      // Use the longest retry delay beyond this
+
+// Cold boot clears the retry and call counts; a deep-sleep timer wake
+// keeps them. The first cycle is due immediately.
+void schedulerInit();
+
+// Report the outcome of a step. A failure schedules the next cycle after
+// the step's backoff (or later, if it was deferred to the next day) and
+// returns that delay.
+void schedulerSucceeded(RefreshStep step);
+uint32_t schedulerFailed(RefreshStep step);
+
+// Schedule the next cycle, e.g. the regular interval after a good fetch
+void schedulerRefreshIn(uint32_t ms);
+
+// False while the step is backing off from a failure
+bool schedulerStepReady(RefreshStep step);
+
+// Count calls about to be made; false (and the step deferred to the
+// next UTC day) if that would exceed the daily limit
+bool schedulerTakeCalls(RefreshStep step, uint16_t calls);
+
+// Count one fetch's calls against the weather provider's own daily
+// limit; false if that would exceed it. For the provider the refresh
+// depends on (deferStep) the weather step is then deferred to the next
+// UTC day, and its retries slow down near the limit; a hedge is just
+// not sent.
+class WeatherProvider;
+bool schedulerTakeWeatherCalls(const WeatherProvider& provider, bool deferStep);
+
+// Milliseconds until the next cycle should start; 0 = now
+uint32_t schedulerMsUntilRefresh();
@@ -0,0 +1,68 @@
+#include "request_budget.h"
+
+#include "Arduino.h"
+
+static uint32_t phaseCapMs(Phase phase) {
+    switch (phase) {
+        case PHASE_DNS:          return BUDGET_DNS_MS;
+        case PHASE_HTTP_CONNECT: return BUDGET_CONNECT_MS;
+        case PHASE_TLS_FULL:
+        case PHASE_TLS_RESUMED:  return BUDGET_TLS_MS;
+        case PHASE_HTTP_TTFB:    return BUDGET_TTFB_MS;
+        case PHASE_HTTP_BODY:    return BUDGET_BODY_MS;
+        case PHASE_GEOLOCATION:  return BUDGET_GEOLOCATION_MS;
+        case PHASE_NTP_SYNC:     return BUDGET_NTP_MS;
+        default:                 return UINT32_MAX;
+    }
+}
+
+void RequestBudget::begin(uint32_t total) {
+    startMs = millis();
+    totalMs = total;
+    active = true;
+    exhaustedPhase = PHASE_COUNT;
+}
+
+uint32_t RequestBudget::spentMs() const {
+    return millis() - startMs;
+}
+
+uint32_t RequestBudget::remainingMs() const {
+    if (!active) return UINT32_MAX;
+    uint32_t spent = spentMs();
+    return spent < totalMs ? totalMs - spent : 0;
+}
+
+uint32_t RequestBudget::allow(Phase phase) const {
+    if (exhausted()) return 0;
+    uint32_t cap = phaseCapMs(phase);
+    uint32_t left = remainingMs();
+    return cap < left ? cap : left;
+}
+
+bool RequestBudget::cannotStart(Phase phase) {
+    if (exhausted()) return true;
+    if (allow(phase) >= BUDGET_MIN_START_MS) return false;
+    exhaust(phase);
+    return true;
+}
+
+void RequestBudget::exhaust(Phase phase) {
+    if (exhausted()) return;
+    exhaustedPhase = phase;
+    phaseRecordTimeout(phase);
+}
+
+void RequestBudget::finish(const char* label) {
+    if (!active) return;
+    active = false;
+    if (exhausted()) {
+        Serial.printf("✗ %s cancelled: %s ran out of time, %lu of %lu ms spent\n", label,
+                      phaseName(exhaustedPhase), (unsigned long)spentMs(),
+                      (unsigned long)totalMs);
+    } else {
+        Serial.printf("%s took %lu of %lu ms budget\n", label, (unsigned long)spentMs(),
+                      (unsigned long)totalMs);
+    }
+    exhaustedPhase = PHASE_COUNT;
+}
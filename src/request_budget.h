@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include "phase_timer.h"
+
+// ========================================
+// Refresh Deadline Budget
+// ========================================
+// Each refresh cycle (location check, timezone lookup, weather fetch) gets
+// one overall time budget. Every blocking step asks for its share: its
+// own cap, or whatever is left of the budget if that is less. The first
+// step to run out marks the budget exhausted; callers then abandon the
+// cycle, leaving the published forecast (and the screen) untouched.
+//
+// WiFi association happens before the budget starts. DNS and the
+// WifiLocation library can't be interrupted, so they are checked when
+// they return.
+
+#ifndef REFRESH_BUDGET_MS
+#define REFRESH_BUDGET_MS        40000
+#endif
+
+// Per-phase caps (ms)
+#define BUDGET_DNS_MS            4000
+#define BUDGET_CONNECT_MS        5000
+#define BUDGET_TLS_MS            8000    // Either kind of handshake
+#define BUDGET_TTFB_MS           8000    // Request written -> headers read
+#define BUDGET_BODY_MS           10000   // Whole body, not per read
+#define BUDGET_GEOLOCATION_MS    15000
+#define BUDGET_NTP_MS            10000
+#define BUDGET_MIN_START_MS      1000    // Don't start a step with less left
+
+class RequestBudget {
+public:
+    void begin(uint32_t totalMs = REFRESH_BUDGET_MS);
+
+    uint32_t remainingMs() const;
+    uint32_t spentMs() const;
+
+    // Time the phase may take: min(its cap, what's left)
+    uint32_t allow(Phase phase) const;
+
+    // True if a step of this phase should not start; marks the budget
+    // exhausted by it
+    bool cannotStart(Phase phase);
+
+    // Record that a phase ran out of time; the first one is kept
+    void exhaust(Phase phase);
+    bool exhausted() const { return exhaustedPhase != PHASE_COUNT; }
+    Phase exhaustedBy() const { return exhaustedPhase; }
+
+    // Log time spent and, if cancelled, which phase ran out. Afterwards
+    // only the per-phase caps apply until the next begin().
+    void finish(const char* label);
+
+private:
+    uint32_t startMs = 0;
+    uint32_t totalMs = 0;
+    bool active = false;
+    Phase exhaustedPhase = PHASE_COUNT;
+};
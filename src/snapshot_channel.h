@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+// ========================================
+// Lock-free Single-Producer/Single-Consumer Handoff
+// ========================================
+// Triple buffer: the producer fills its private back slot and publishes
+// it by swapping it with the shared middle slot; the consumer swaps the
+// middle slot with its private front slot when a fresh one is waiting.
+// Neither side ever blocks or sees a slot the other is writing, and the
+// consumer always gets the newest complete value (older unread ones are
+// dropped, which is what a display wants).
+
+template <typename T>
+class SnapshotChannel {
+public:
+    // Producer: the slot to fill before calling publish()
+    T& writeSlot() { return slots[back]; }
+
+    // Producer: hand the filled slot to the consumer
+    void publish() {
+        uint8_t prev = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = prev & INDEX_MASK;
+    }
+
+    // Consumer: take the newest published slot, if any.
+    // Returns false when nothing new has been published since last time.
+    bool acquire() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        uint8_t prev = middle.exchange(front, std::memory_order_acq_rel);
+        front = prev & INDEX_MASK;
+        return true;
+    }
+
+    // Consumer: the slot returned by the last successful acquire()
+    const T& current() const { return slots[front]; }
+
+private:
+    static const uint8_t INDEX_MASK = 0x03;
+    static const uint8_t FRESH = 0x04;
+
+    T slots[3];
+    uint8_t back = 0;                  // Owned by the producer
+    uint8_t front = 1;                 // Owned by the consumer
+    std::atomic<uint8_t> middle{2};    // Shared, FRESH set when unread
+};
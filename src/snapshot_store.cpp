@@ -0,0 +1,101 @@
+#include "snapshot_store.h"
+
+#include <Preferences.h>
+#include "esp_rom_crc.h"
+
+static uint32_t recordCrc(const SnapshotRecord& rec) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&rec, offsetof(SnapshotRecord, crc));
+}
+
+void packSnapshot(const WeatherSnapshot& weather, const Location& location, SnapshotRecord& rec) {
+    memset(&rec, 0, sizeof(rec));
+    rec.magic = SNAPSHOT_MAGIC;
+    rec.version = SNAPSHOT_VERSION;
+    rec.size = sizeof(rec);
+    rec.fetchedAt = weather.fetchedAt;
+    rec.timezoneOffset = weather.timezoneOffset;
+    rec.currentTemp = weather.currentTemp;
+    strlcpy(rec.currentCondition, weather.currentCondition, sizeof(rec.currentCondition));
+    rec.latitude = location.latitude;
+    rec.longitude = location.longitude;
+    strlcpy(rec.city, location.city, sizeof(rec.city));
+    rec.locationValid = location.isValid;
+
+    for (int i = 0; i < 3; i++) {
+        const WeatherDay& src = weather.forecast[i];
+        SnapshotDayRecord& dst = rec.days[i];
+        strlcpy(dst.day_name, src.day_name, sizeof(dst.day_name));
+        strlcpy(dst.date, src.date, sizeof(dst.date));
+        strlcpy(dst.description, src.description, sizeof(dst.description));
+        dst.temp_high = src.temp_high;
+        dst.temp_low = src.temp_low;
+        dst.humidity = src.humidity;
+    }
+    rec.crc = recordCrc(rec);
+}
+
+bool unpackSnapshot(const SnapshotRecord& rec, WeatherSnapshot& weather, Location& location) {
+    if (rec.magic != SNAPSHOT_MAGIC || rec.version != SNAPSHOT_VERSION || rec.size != sizeof(rec)) {
+        Serial.println("Snapshot: incompatible record, ignoring");
+        return false;
+    }
+    if (rec.crc != recordCrc(rec)) {
+        Serial.println("Snapshot: CRC mismatch, ignoring");
+        return false;
+    }
+
+    weather.fetchedAt = (time_t)rec.fetchedAt;
+    weather.timezoneOffset = rec.timezoneOffset;
+    weather.currentTemp = rec.currentTemp;
+    strlcpy(weather.currentCondition, rec.currentCondition, sizeof(weather.currentCondition));
+    for (int i = 0; i < 3; i++) {
+        const SnapshotDayRecord& src = rec.days[i];
+        WeatherDay& dst = weather.forecast[i];
+        strlcpy(dst.day_name, src.day_name, sizeof(dst.day_name));
+        strlcpy(dst.date, src.date, sizeof(dst.date));
+        strlcpy(dst.description, src.description, sizeof(dst.description));
+        dst.temp_high = src.temp_high;
+        dst.temp_low = src.temp_low;
+        dst.humidity = src.humidity;
+    }
+
+    location.latitude = rec.latitude;
+    location.longitude = rec.longitude;
+    strlcpy(location.city, rec.city, sizeof(location.city));
+    location.lastLocationCheck = 0;
+    location.isValid = rec.locationValid;
+
+    return true;
+}
+
+bool saveWeatherSnapshot(const WeatherSnapshot& weather, const Location& location) {
+    SnapshotRecord rec;
+    packSnapshot(weather, location, rec);
+
+    Preferences prefs;
+    if (!prefs.begin(SNAPSHOT_NVS_NAMESPACE, false)) {
+        Serial.println("Snapshot: NVS unavailable, not saved");
+        return false;
+    }
+    size_t written = prefs.putBytes(SNAPSHOT_NVS_KEY, &rec, sizeof(rec));
+    prefs.end();
+
+    return written == sizeof(rec);
+}
+
+bool loadWeatherSnapshot(WeatherSnapshot& weather, Location& location) {
+    Preferences prefs;
+    if (!prefs.begin(SNAPSHOT_NVS_NAMESPACE, true)) {
+        return false;  // Namespace doesn't exist yet (first boot)
+    }
+
+    SnapshotRecord rec;
+    size_t len = prefs.getBytesLength(SNAPSHOT_NVS_KEY);
+    bool ok = (len == sizeof(rec)) &&
+              prefs.getBytes(SNAPSHOT_NVS_KEY, &rec, sizeof(rec)) == sizeof(rec);
+    prefs.end();
+
+    if (!ok || !unpackSnapshot(rec, weather, location)) return false;
+    weather.restored = true;
+    return true;
+}
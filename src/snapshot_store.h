@@ -0,0 +1,58 @@
+#pragma once
+
+#include "weather_types.h"
+
+// ========================================
+// Persisted Forecast Snapshot
+// ========================================
+// The last good fetch is kept in NVS as a fixed-size, versioned binary
+// record with a CRC32, so the display can be drawn at power-on before
+// any network activity. Bump SNAPSHOT_VERSION whenever the record
+// layout changes; older records are then ignored.
+
+#define SNAPSHOT_NVS_NAMESPACE "weather"
+#define SNAPSHOT_NVS_KEY       "snapshot"
+#define SNAPSHOT_MAGIC         0x57534E50  // "WSNP"
+#define SNAPSHOT_VERSION       2  // 2: temperatures in tenths of a degree
+
+// On-flash layout. Fixed-size fields only, so the record can be written
+// and read as one blob; crc covers every byte before it.
+struct SnapshotDayRecord {
+    char day_name[4];      // "Mon"
+    char date[6];          // "MM-DD"
+    char description[32];
+    int16_t temp_high;     // Tenths of a degree
+    int16_t temp_low;
+    uint8_t humidity;
+};
+
+struct SnapshotRecord {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;
+    int64_t fetchedAt;
+    int32_t timezoneOffset;
+    int16_t currentTemp;   // Tenths of a degree
+    char currentCondition[32];
+    float latitude;
+    float longitude;
+    char city[32];
+    uint8_t locationValid;
+    SnapshotDayRecord days[3];
+    uint32_t crc;
+};
+
+// Fill a record (including its CRC) from the snapshot and location
+void packSnapshot(const WeatherSnapshot& weather, const Location& location, SnapshotRecord& rec);
+
+// Restore from a record; returns false if it fails the
+// magic/version/size/CRC checks. Leaves weather.restored untouched.
+bool unpackSnapshot(const SnapshotRecord& rec, WeatherSnapshot& weather, Location& location);
+
+// Write the snapshot and location; returns false if NVS is unavailable
+bool saveWeatherSnapshot(const WeatherSnapshot& weather, const Location& location);
+
+// Restore the last snapshot; returns false if none exists or the record
+// fails the magic/version/size/CRC checks. On success weather.restored
+// is set so the display marks the data stale.
+bool loadWeatherSnapshot(WeatherSnapshot& weather, Location& location);
@@ -0,0 +1,52 @@
+#include "text_format.h"
+
+// Truncated toward zero, not rounded: roundTenths() then gives the same
+// whole degree as rounding the original value. Rounding twice would show
+// 72.46 as 72.5 and then 73.
+int16_t tenthsFromFloat(float value) {
+    float scaled = value * 10.0f;
+    if (scaled >= INT16_MAX) return INT16_MAX;
+    if (scaled <= INT16_MIN) return INT16_MIN;
+    return (int16_t)scaled;
+}
+
+int16_t roundTenths(int16_t tenths) {
+    return (int16_t)((tenths >= 0 ? tenths + 5 : tenths - 5) / 10);
+}
+
+TextBuilder& TextBuilder::chr(char c) {
+    if (len + 1 < cap) {
+        buf[len++] = c;
+        buf[len] = '\0';
+    }
+    return *this;
+}
+
+TextBuilder& TextBuilder::str(const char* s) {
+    while (s && *s) chr(*s++);
+    return *this;
+}
+
+TextBuilder& TextBuilder::integer(int32_t value) {
+    // Digits come out least significant first
+    char digits[11];
+    int n = 0;
+    uint32_t magnitude = value < 0 ? 0u - (uint32_t)value : (uint32_t)value;
+    do {
+        digits[n++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+
+    if (value < 0) chr('-');
+    while (n > 0) chr(digits[--n]);
+    return *this;
+}
+
+TextBuilder& TextBuilder::twoDigits(uint32_t value) {
+    chr((char)('0' + (value / 10) % 10));
+    return chr((char)('0' + value % 10));
+}
+
+TextBuilder& TextBuilder::degrees(int16_t tenths) {
+    return integer(roundTenths(tenths));
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ========================================
+// Allocation-free Text Formatting
+// ========================================
+// Builds label text into caller-owned buffers with a small integer
+// formatter instead of snprintf/String, so the render path never touches
+// the heap. Output is always NUL-terminated and silently truncated at
+// the buffer size. Plain C++ only; nothing here depends on Arduino.
+
+// Temperatures are int16 fixed point in tenths of a degree (truncated,
+// see text_format.cpp)
+int16_t tenthsFromFloat(float value);
+
+// Whole degrees, rounded half away from zero
+int16_t roundTenths(int16_t tenths);
+
+class TextBuilder {
+public:
+    TextBuilder(char* buffer, size_t size) : buf(buffer), cap(size), len(0) {
+        if (cap > 0) buf[0] = '\0';
+    }
+
+    TextBuilder& str(const char* s);
+    TextBuilder& chr(char c);
+    TextBuilder& integer(int32_t value);
+    TextBuilder& twoDigits(uint32_t value);     // Zero-padded, "07"
+    TextBuilder& degrees(int16_t tenths);      // Rounded whole degrees
+
+    const char* c_str() const { return buf; }
+    size_t length() const { return len; }
+
+private:
+    char* buf;
+    size_t cap;
+    size_t len;
+};
@@ -0,0 +1,285 @@
+#include "tls_channel.h"
+
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "mbedtls/net_sockets.h"
+#include "phase_timer.h"
+
+#define TLS_RTC_MAGIC 0x544C5353  // "TLSS"
+
+// Serialized session kept over deep sleep; crc covers every byte before it
+struct TlsRtcSession {
+    uint32_t magic;
+    uint32_t hostHash;
+    uint32_t length;
+    uint8_t data[TLS_RTC_SESSION_MAX];
+    uint32_t crc;
+};
+
+RTC_DATA_ATTR static TlsRtcSession rtcSession;
+
+static uint32_t rtcSessionCrc() {
+    return esp_rom_crc32_le(0, (const uint8_t*)&rtcSession, offsetof(TlsRtcSession, crc));
+}
+
+static uint32_t hostHash(const char* host) {
+    return esp_rom_crc32_le(0, (const uint8_t*)host, strlen(host));
+}
+
+// ----------------------------------------
+// WiFiClient as the mbedTLS transport
+// ----------------------------------------
+
+static int bioSend(void* ctx, const unsigned char* buf, size_t len) {
+    WiFiClient* tcp = (WiFiClient*)ctx;
+    int n = tcp->write(buf, len);
+    return n > 0 ? n : MBEDTLS_ERR_NET_SEND_FAILED;
+}
+
+// Never blocks: the caller decides how long to wait
+static int bioRecv(void* ctx, unsigned char* buf, size_t len) {
+    WiFiClient* tcp = (WiFiClient*)ctx;
+    if (tcp->available() <= 0) {
+        return tcp->connected() ? MBEDTLS_ERR_SSL_WANT_READ : MBEDTLS_ERR_NET_CONN_RESET;
+    }
+    int n = tcp->read(buf, len);
+    return n > 0 ? n : MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+// Called for each certificate of the chain the server sends, which it
+// only does in a full handshake; a resumed one skips the exchange. Leaves
+// the verdict (flags) to mbedTLS.
+static int onVerifyCertificate(void* ctx, mbedtls_x509_crt* crt, int depth, uint32_t* flags) {
+    *(bool*)ctx = true;
+    return 0;
+}
+
+// ----------------------------------------
+// Channel
+// ----------------------------------------
+
+bool TlsChannel::init() {
+    if (ready) return true;
+
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&drbg);
+    mbedtls_x509_crt_init(&caChain);
+    mbedtls_ssl_config_init(&conf);
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_session_init(&session);
+
+    static const char PERSONALIZATION[] = "lilygo-weather";
+    int ret = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy,
+                                    (const unsigned char*)PERSONALIZATION,
+                                    sizeof(PERSONALIZATION) - 1);
+    if (ret == 0) {
+        // PEM parsing needs the terminating NUL in the length
+        ret = mbedtls_x509_crt_parse(&caChain, (const unsigned char*)caPem, strlen(caPem) + 1);
+    }
+    if (ret == 0) {
+        ret = mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT,
+                                          MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT);
+    }
+    if (ret != 0) {
+        Serial.printf("✗ TLS setup failed (-0x%04x)\n", -ret);
+        return false;
+    }
+    mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_ca_chain(&conf, &caChain, nullptr);
+    mbedtls_ssl_conf_verify(&conf, onVerifyCertificate, &certificateSeen);
+    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+    // Allocates the record buffers; every connection after this reuses them
+    ret = mbedtls_ssl_setup(&ssl, &conf);
+    if (ret != 0) {
+        Serial.printf("✗ TLS setup failed (-0x%04x)\n", -ret);
+        return false;
+    }
+
+    if (keepInRtc) restoreSession();
+    ready = true;
+    return true;
+}
+
+bool TlsChannel::handshake(WiFiClient& tcp, const char* host, uint32_t timeoutMs) {
+    open = false;
+    resumed = false;
+    if (!init()) return false;
+
+    mbedtls_ssl_session_reset(&ssl);
+    mbedtls_ssl_set_hostname(&ssl, host);
+    mbedtls_ssl_set_bio(&ssl, &tcp, bioSend, bioRecv, nullptr);
+    bool offered = haveSession && sessionHostHash == hostHash(host) &&
+                   mbedtls_ssl_set_session(&ssl, &session) == 0;
+
+    // Free heap is sampled each time the handshake waits for the socket;
+    // the allocator's low watermark catches the dips in between (the key
+    // exchange maths) when they set a new record
+    size_t freeBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    size_t watermarkBefore = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    size_t lowest = freeBefore;
+    certificateSeen = false;
+    unsigned long start = millis();
+    int64_t startUs = esp_timer_get_time();
+
+    int ret;
+    bool timedOut = false;
+    while ((ret = mbedtls_ssl_handshake(&ssl)) == MBEDTLS_ERR_SSL_WANT_READ ||
+           ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+        size_t freeNow = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        if (freeNow < lowest) lowest = freeNow;
+        if (millis() - start > timeoutMs) {
+            timedOut = true;
+            break;
+        }
+        delay(1);
+    }
+    size_t watermarkAfter = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    if (watermarkAfter < watermarkBefore && watermarkAfter < lowest) lowest = watermarkAfter;
+
+    uint32_t elapsedMs = millis() - start;
+    if (ret != 0) {
+        if (timedOut) {
+            Serial.printf("✗ TLS handshake with %s timed out after %lu ms\n", host,
+                          (unsigned long)elapsedMs);
+        } else {
+            Serial.printf("✗ TLS handshake with %s failed (-0x%04x)\n", host, -ret);
+        }
+        // Don't offer a session the server may be choking on
+        haveSession = false;
+        return false;
+    }
+
+    open = true;
+    resumed = offered && !certificateSeen;
+    uint32_t heapBytes = freeBefore - lowest;
+    phaseRecord(resumed ? PHASE_TLS_RESUMED : PHASE_TLS_FULL,
+                (uint32_t)(esp_timer_get_time() - startUs));
+
+    Stats& stats = resumed ? abbreviated : full;
+    stats.count++;
+    stats.totalMs += elapsedMs;
+    if (heapBytes > stats.maxHeapBytes) stats.maxHeapBytes = heapBytes;
+    cycleHandshakeMs += elapsedMs;
+    cycleResumed = resumed;
+
+    Serial.printf("TLS: %s handshake with %s in %lu ms, %u bytes heap, %s\n",
+                  resumed ? "resumed" : "full", host, (unsigned long)elapsedMs,
+                  (unsigned)heapBytes, mbedtls_ssl_get_ciphersuite(&ssl));
+
+    // Servers may issue a fresh ticket on resumption too
+    saveSession(host);
+    return true;
+}
+
+int TlsChannel::read(uint8_t* buf, size_t size) {
+    if (!open) return -1;
+    int n = mbedtls_ssl_read(&ssl, buf, size);
+    if (n > 0) return n;
+    if (n == MBEDTLS_ERR_SSL_WANT_READ || n == MBEDTLS_ERR_SSL_WANT_WRITE) return 0;
+    // 0 or PEER_CLOSE_NOTIFY is an orderly close, anything else an error
+    open = false;
+    return -1;
+}
+
+size_t TlsChannel::write(const uint8_t* buf, size_t len) {
+    size_t sent = 0;
+    while (open && sent < len) {
+        int n = mbedtls_ssl_write(&ssl, buf + sent, len - sent);
+        if (n > 0) {
+            sent += n;
+        } else if (n != MBEDTLS_ERR_SSL_WANT_WRITE && n != MBEDTLS_ERR_SSL_WANT_READ) {
+            open = false;
+        }
+    }
+    return sent;
+}
+
+size_t TlsChannel::pending() {
+    return open ? mbedtls_ssl_get_bytes_avail(&ssl) : 0;
+}
+
+void TlsChannel::close() {
+    if (!open) return;
+    mbedtls_ssl_close_notify(&ssl);
+    open = false;
+}
+
+// Keep the new session for the next handshake, and in RTC memory for the
+// next wake
+void TlsChannel::saveSession(const char* host) {
+    if (mbedtls_ssl_get_session(&ssl, &session) != 0) {
+        haveSession = false;
+        return;
+    }
+    haveSession = true;
+    sessionHostHash = hostHash(host);
+    if (!keepInRtc) return;
+
+    size_t length = 0;
+    rtcSession.magic = 0;
+    if (mbedtls_ssl_session_save(&session, rtcSession.data, sizeof(rtcSession.data),
+                                 &length) != 0) {
+        Serial.printf("TLS: session needs %u bytes, not kept over deep sleep\n",
+                      (unsigned)length);
+        return;
+    }
+    rtcSession.hostHash = sessionHostHash;
+    rtcSession.length = length;
+    rtcSession.magic = TLS_RTC_MAGIC;
+    rtcSession.crc = rtcSessionCrc();
+}
+
+void TlsChannel::restoreSession() {
+    if (rtcSession.magic != TLS_RTC_MAGIC || rtcSession.length > sizeof(rtcSession.data) ||
+        rtcSession.crc != rtcSessionCrc()) {
+        return;
+    }
+    if (mbedtls_ssl_session_load(&session, rtcSession.data, rtcSession.length) != 0) {
+        // Saved by a different mbedTLS build or config
+        mbedtls_ssl_session_free(&session);
+        mbedtls_ssl_session_init(&session);
+        rtcSession.magic = 0;
+        return;
+    }
+    haveSession = true;
+    sessionHostHash = rtcSession.hostHash;
+    Serial.println("TLS: session restored from RTC memory");
+}
+
+void TlsChannel::logCycle(uint32_t refreshMs) {
+    if (cycleHandshakeMs == 0 || refreshMs == 0) {
+        cycleHandshakeMs = 0;
+        return;
+    }
+    float share = (float)cycleHandshakeMs / refreshMs;
+    Stats& stats = cycleResumed ? abbreviated : full;
+    stats.cycles++;
+    stats.shareSum += share;
+    Serial.printf("TLS: handshake %lu of %lu ms refresh (%.0f%%, %s)\n",
+                  (unsigned long)cycleHandshakeMs, (unsigned long)refreshMs, share * 100,
+                  cycleResumed ? "resumed" : "full");
+    cycleHandshakeMs = 0;
+}
+
+void TlsChannel::dumpReport() {
+    Serial.println("\n--- TLS handshakes ---");
+    const Stats* kinds[] = {&full, &abbreviated};
+    const char* names[] = {"full", "resumed"};
+    for (int i = 0; i < 2; i++) {
+        const Stats& s = *kinds[i];
+        if (s.count == 0) {
+            Serial.printf("%-8s n=0\n", names[i]);
+            continue;
+        }
+        Serial.printf("%-8s n=%-4u avg %5lu ms  heap peak %6u B", names[i], (unsigned)s.count,
+                      (unsigned long)(s.totalMs / s.count), (unsigned)s.maxHeapBytes);
+        if (s.cycles) Serial.printf("  refresh share %3.0f%%", s.shareSum / s.cycles * 100);
+        Serial.println();
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "Arduino.h"
+#include "WiFi.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+
+// ========================================
+// TLS Channel with Session Resumption
+// ========================================
+// mbedTLS running over an already connected WiFiClient. Everything that is
+// expensive to build is built once and kept: the RNG, the parsed CA
+// bundle, the SSL config and the SSL context itself, whose record buffers
+// are allocated by mbedtls_ssl_setup() and reused (session_reset) for
+// every later connection instead of being freed and allocated again.
+//
+// After each full handshake the negotiated session (ID or ticket) is kept
+// and offered on the next connection, so a refresh normally costs an
+// abbreviated handshake: no certificate chain, no key exchange. The
+// session is also serialized to RTC memory so it survives deep sleep.
+//
+// Each handshake is timed (PHASE_TLS_FULL / PHASE_TLS_RESUMED) along with
+// the heap it took, and dumpReport() compares the two kinds.
+
+#ifndef TLS_RTC_SESSION_MAX
+#define TLS_RTC_SESSION_MAX  2048   // Serialized session kept over deep sleep;
+                                    // includes the peer cert if the build
+                                    // keeps it, otherwise ~200 bytes
+#endif
+
+class TlsChannel {
+public:
+    // caPem must stay valid; it's parsed on first use. There is RTC
+    // memory for one session: only one channel should keep it there.
+    explicit TlsChannel(const char* caPem, bool keepInRtc = true)
+        : caPem(caPem), keepInRtc(keepInRtc) {}
+
+    // Handshake with host over tcp, offering the saved session if it was
+    // made with the same host. False on failure or after timeoutMs.
+    bool handshake(WiFiClient& tcp, const char* host, uint32_t timeoutMs);
+
+    // Decrypted bytes: >0 read, 0 nothing yet, <0 closed or failed
+    int read(uint8_t* buf, size_t size);
+    size_t write(const uint8_t* buf, size_t len);
+
+    // Decrypted bytes that can be read without touching the socket
+    size_t pending();
+
+    // Send close_notify (best effort); the TCP side is the caller's
+    void close();
+
+    bool isOpen() const { return open; }
+    bool lastResumed() const { return resumed; }
+
+    // Log this refresh's handshake time as a share of refreshMs, then
+    // start counting the next refresh
+    void logCycle(uint32_t refreshMs);
+
+    // Print full vs resumed handshake time, heap and refresh share
+    void dumpReport();
+
+private:
+    struct Stats {
+        uint32_t count;
+        uint32_t totalMs;
+        uint32_t maxHeapBytes;
+        uint32_t cycles;          // Refreshes whose handshake was this kind
+        float shareSum;           // Sum of handshake / refresh time
+    };
+
+    bool init();
+    void saveSession(const char* host);
+    void restoreSession();
+
+    const char* caPem;
+    bool keepInRtc;
+    bool ready = false;
+    bool open = false;
+    bool resumed = false;
+    bool certificateSeen = false;   // Set by the verify callback: a full handshake
+
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_x509_crt caChain;
+    mbedtls_ssl_config conf;
+    mbedtls_ssl_context ssl;
+
+    mbedtls_ssl_session session;
+    bool haveSession = false;
+    uint32_t sessionHostHash = 0;
+
+    Stats full = {};
+    Stats abbreviated = {};
+    uint32_t cycleHandshakeMs = 0;
+    bool cycleResumed = false;
+};
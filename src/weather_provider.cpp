@@ -0,0 +1,153 @@
+#include "weather_provider.h"
+
+#include "esp_heap_caps.h"
+#include "deferred_log.h"
+#include "memory_monitor.h"
+#include "phase_timer.h"
+
+bool WeatherProvider::request(HttpSession& session, const Location& location) {
+    cost = {};
+    startMs = millis();
+    heapBefore = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    heapLowest = heapBefore;
+    watermarkBefore = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+
+    if (!session.connect(host, port, tls)) {
+        LOG_ERROR("%s: connection to %s failed\n", name(), host);
+        session.close();
+        return finish(false);
+    }
+    sampleHeap();   // The TLS handshake's buffers are still held here
+    if (!sendRequests(session, location)) {
+        LOG_ERROR("%s: sending requests failed\n", name());
+        session.close();
+        return finish(false);
+    }
+    return true;
+}
+
+bool WeatherProvider::receive(HttpSession& session, WeatherReport& report) {
+    // The last fetch's documents are gone; start the arena over
+    arena.reset();
+    arena.resetHighWater();
+
+    report.city[0] = '\0';
+    report.currentCondition[0] = '\0';
+    report.hourlyCount = 0;
+    report.dailyCount = 0;
+
+    bool ok = readResponses(session, report);
+    if (ok && report.hourlyCount == 0) {
+        LOG_ERROR("%s: response had no hourly data\n", name());
+        ok = false;
+    }
+    if (!ok) session.close();
+    return finish(ok);
+}
+
+bool WeatherProvider::fetch(HttpSession& session, const Location& location,
+                            WeatherReport& report) {
+    return request(session, location) && receive(session, report);
+}
+
+bool WeatherProvider::expectOk(HttpSession& session, const char* label) {
+    int status = session.readResponse();
+    if (status != 200) {
+        LOG_ERROR("%s %s HTTP error: %d\n", name(), label, status);
+        return false;
+    }
+    return true;
+}
+
+DeserializationError WeatherProvider::parse(HttpSession& session, JsonDocument& doc,
+                                            JsonDocument& filter, const char* label) {
+    DeserializationError error;
+    int64_t start = esp_timer_get_time();
+    {
+        PhaseTimer timer(PHASE_JSON_PARSE);
+        MemoryScope memory(MEM_SPAN_JSON_PARSE);
+        error = deserializeJson(doc, session.body(), DeserializationOption::Filter(filter));
+    }
+    cost.parseUs += (uint32_t)(esp_timer_get_time() - start);
+    sampleHeap();
+
+    bool reusable = session.finishResponse(label);
+    cost.wireBytes += session.timings().wireBytes;
+    cost.bodyBytes += session.timings().bodyBytes;
+
+    if (error) {
+        LOG_ERROR("%s %s JSON error: %s\n", name(), label, error.c_str());
+    } else if (!reusable && session.timings().bodyFailed) {
+        // The JSON closed, but the body was truncated or failed its gzip
+        // check: the document can't be trusted
+        LOG_ERROR("%s %s body incomplete or corrupt\n", name(), label);
+        error = DeserializationError::IncompleteInput;
+    }
+    return error;
+}
+
+void WeatherProvider::sampleHeap() {
+    size_t freeNow = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    if (freeNow < heapLowest) heapLowest = freeNow;
+}
+
+bool WeatherProvider::finish(bool ok) {
+    // A dip between samples shows up if it set a new minimum-ever record
+    size_t watermarkAfter = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    if (watermarkAfter < watermarkBefore && watermarkAfter < heapLowest) {
+        heapLowest = watermarkAfter;
+    }
+    cost.fetchMs = millis() - startMs;
+    cost.arenaPeak = arena.highWater();
+    cost.heapDip = heapBefore > heapLowest ? heapBefore - heapLowest : 0;
+
+    sum.fetches++;
+    if (!ok) {
+        sum.failures++;
+        return false;
+    }
+    sum.fetchMs += cost.fetchMs;
+    sum.wireBytes += cost.wireBytes;
+    sum.bodyBytes += cost.bodyBytes;
+    sum.parseUs += cost.parseUs;
+    if (cost.arenaPeak > sum.maxArenaPeak) sum.maxArenaPeak = cost.arenaPeak;
+    if (cost.heapDip > sum.maxHeapDip) sum.maxHeapDip = cost.heapDip;
+    LOG_INFO("%s: %u ms, %u bytes on the wire (%u decoded), parse %u us, arena %u B, heap %u B\n",
+             name(), cost.fetchMs, cost.wireBytes, cost.bodyBytes, cost.parseUs,
+             cost.arenaPeak, cost.heapDip);
+    return true;
+}
+
+void providerBenchmark(WeatherProvider* const* providers, int count, int runs,
+                       HttpSession& session, const Location& location) {
+    // Too big for the task stack
+    static WeatherReport report;
+
+    Serial.printf("\nBenchmarking %d providers, %d fetches each...\n", count, runs);
+    for (int run = 0; run < runs; run++) {
+        for (int i = 0; i < count; i++) {
+            // Cold connection every time, as in a real refresh cycle
+            providers[i]->fetch(session, location, report);
+            session.close();
+        }
+    }
+    logFlush();
+
+    Serial.println("\n--- Weather providers ---");
+    Serial.println("provider     ok/n   wire B   body B  parse ms  fetch ms  arena B   heap B");
+    for (int i = 0; i < count; i++) {
+        const WeatherProvider::Totals& t = providers[i]->totals();
+        uint32_t ok = t.fetches - t.failures;
+        if (ok == 0) {
+            Serial.printf("%-11s %2u/%-2u  (no successful fetch)\n", providers[i]->name(),
+                          (unsigned)ok, (unsigned)t.fetches);
+            continue;
+        }
+        Serial.printf("%-11s %2u/%-2u %8u %8u %9.1f %9u %8u %8u\n", providers[i]->name(),
+                      (unsigned)ok, (unsigned)t.fetches, (unsigned)(t.wireBytes / ok),
+                      (unsigned)(t.bodyBytes / ok), t.parseUs / 1000.0 / ok,
+                      (unsigned)(t.fetchMs / ok), (unsigned)t.maxArenaPeak,
+                      (unsigned)t.maxHeapDip);
+    }
+    Serial.println("(averages per fetch; arena and heap are the worst seen)");
+}
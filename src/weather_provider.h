@@ -0,0 +1,110 @@
+#pragma once
+
+#include "ArduinoJson.h"
+#include "http_session.h"
+#include "json_arena.h"
+#include "weather_types.h"
+
+// ========================================
+// Weather Provider Backends
+// ========================================
+// A provider turns a location into a WeatherReport: a normalized hourly
+// series (UTC timestamps, tenths of a degree, humidity, description)
+// plus whatever daily aggregates the API computes itself. Per-day
+// grouping, DST handling and the Day 0 rules stay with the caller, so
+// every backend feeds the same ForecastAggregator.
+//
+// Each backend owns its host, port and TLS channel and issues its own
+// requests on the HttpSession it's given; parse documents come from the
+// shared JSON arena. Every fetch is metered (bytes on the wire, parse
+// time, arena and heap peak) so backends can be compared with
+// providerBenchmark() against real APIs or tools/mock_api_server.py.
+
+#define WEATHER_PROVIDER_OWM         0   // OpenWeatherMap: weather + 5 day/3 hour forecast
+#define WEATHER_PROVIDER_OPEN_METEO  1   // Open-Meteo: one key-free hourly+daily request
+#define WEATHER_PROVIDER_COUNT       2
+
+// What one fetch cost
+struct ProviderCost {
+    uint32_t fetchMs;      // Connect until the last body is parsed
+    uint32_t wireBytes;    // Body bytes as received, all requests
+    uint32_t bodyBytes;    // Decoded
+    uint32_t parseUs;      // deserializeJson() total
+    uint32_t arenaPeak;    // JSON arena high water
+    uint32_t heapDip;      // Internal heap free at the start minus the lowest sample
+};
+
+class WeatherProvider {
+public:
+    WeatherProvider(const char* host, uint16_t port, TlsChannel* tls, JsonArena& arena)
+        : host(host), port(port), tls(tls), arena(arena) {}
+    virtual ~WeatherProvider() {}
+
+    virtual const char* name() const = 0;
+
+    // WEATHER_PROVIDER_* of this backend
+    virtual uint8_t id() const = 0;
+
+    // HTTP requests per fetch, and the provider's own limit on them per
+    // day (0 = none), for the daily call budget
+    virtual uint8_t callsPerFetch() const = 0;
+    virtual uint16_t dailyCallLimit() const = 0;
+
+    // Connect (or reuse the session's connection) and write the requests
+    bool request(HttpSession& session, const Location& location);
+
+    // Read and parse the responses to request(). Starts the JSON arena
+    // over. On failure the report is incomplete.
+    bool receive(HttpSession& session, WeatherReport& report);
+
+    // Both of the above. On failure the session is closed.
+    bool fetch(HttpSession& session, const Location& location, WeatherReport& report);
+
+    const ProviderCost& lastCost() const { return cost; }
+
+    // Totals over every metered fetch, for the benchmark table
+    struct Totals {
+        uint32_t fetches;
+        uint32_t failures;
+        uint64_t fetchMs;
+        uint64_t wireBytes;
+        uint64_t bodyBytes;
+        uint64_t parseUs;
+        uint32_t maxArenaPeak;
+        uint32_t maxHeapDip;
+    };
+    const Totals& totals() const { return sum; }
+
+protected:
+    virtual bool sendRequests(HttpSession& session, const Location& location) = 0;
+    virtual bool readResponses(HttpSession& session, WeatherReport& report) = 0;
+
+    // Read the next response's headers; logs and returns false unless 200
+    bool expectOk(HttpSession& session, const char* label);
+
+    // Parse the current response body through a filter, then finish the
+    // response. Metered.
+    DeserializationError parse(HttpSession& session, JsonDocument& doc, JsonDocument& filter,
+                               const char* label);
+
+    const char* host;
+    uint16_t port;
+    TlsChannel* tls;
+    JsonArena& arena;
+
+private:
+    void sampleHeap();
+    bool finish(bool ok);
+
+    ProviderCost cost = {};
+    Totals sum = {};
+    unsigned long startMs = 0;
+    size_t heapBefore = 0;
+    size_t heapLowest = 0;
+    size_t watermarkBefore = 0;
+};
+
+// Fetch from each provider `runs` times in turn and print bytes, parse
+// time, fetch time and memory side by side
+void providerBenchmark(WeatherProvider* const* providers, int count, int runs,
+                       HttpSession& session, const Location& location);
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+// Plain structs with fixed-size buffers: copying, persisting or
+// refreshing them never allocates. Temperatures are int16 fixed point in
+// tenths of a degree (in the configured units); see text_format.h.
+
+#define WEATHER_DATE_LEN      6   // "MM-DD"
+#define WEATHER_DAY_NAME_LEN  4   // "Mon"
+#define WEATHER_DESC_LEN      32  // Longest OWM description is ~28 chars
+#define LOCATION_CITY_LEN     32
+
+// Weather data
+struct WeatherDay {
+    char date[WEATHER_DATE_LEN];
+    char day_name[WEATHER_DAY_NAME_LEN];
+    char description[WEATHER_DESC_LEN];
+    int16_t temp_high;         // Tenths of a degree
+    int16_t temp_low;
+    uint8_t humidity;          // Percent
+};
+
+// Everything the display needs from one successful fetch
+struct WeatherSnapshot {
+    WeatherDay forecast[3];
+    int16_t currentTemp;                        // Tenths of a degree, for Day 0
+    char currentCondition[WEATHER_DESC_LEN];    // Current weather condition for Day 0
+    int32_t timezoneOffset;    // Timezone offset in seconds from UTC (from API)
+    time_t fetchedAt;          // UTC time of the fetch (0 if clock was not synced)
+    bool restored;             // Loaded from flash at boot, not yet refreshed
+};
+
+#define WEATHER_HOURLY_MAX   72   // 3 days of hourly points (OWM sends 40 3-hourly)
+#define WEATHER_DAILY_MAX    3
+
+struct HourlyPoint {
+    int64_t dt;                          // UTC epoch seconds
+    int16_t temp;                        // Tenths of a degree
+    uint8_t humidity;                    // Percent
+    char description[WEATHER_DESC_LEN];
+};
+
+// A day as the provider aggregated it (local calendar day)
+struct DailyPoint {
+    int32_t dayNumber;                   // Days since 1970-01-01, local
+    int16_t tempHigh;                    // Tenths of a degree
+    int16_t tempLow;
+    char description[WEATHER_DESC_LEN];
+};
+
+// What a provider fetched, before per-day grouping (see weather_provider.h)
+struct WeatherReport {
+    char city[LOCATION_CITY_LEN];        // Empty if the provider doesn't name places
+    char currentCondition[WEATHER_DESC_LEN];
+    int16_t currentTemp;                 // Tenths of a degree
+    int32_t utcOffset;                   // Provider's current offset for the location
+    HourlyPoint hourly[WEATHER_HOURLY_MAX];
+    uint8_t hourlyCount;
+    DailyPoint daily[WEATHER_DAILY_MAX];
+    uint8_t dailyCount;                  // 0: aggregate the hourly series only
+};
+
+// Location tracking for WiFi triangulation
+struct Location {
+    float latitude;
+    float longitude;
+    char city[LOCATION_CITY_LEN];
+    unsigned long lastLocationCheck;
+    bool isValid;
+};
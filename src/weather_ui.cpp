@@ -0,0 +1,181 @@
+#include "weather_ui.h"
+
+#include <ctype.h>
+#include <string.h>
+#include "text_format.h"
+
+// LVGL UI objects
+static lv_obj_t *screen;
+static lv_obj_t *title_label;
+static lv_obj_t *day_labels[3];
+static lv_obj_t *temp_labels[3];
+static lv_obj_t *desc_labels[3];
+static lv_obj_t *update_label;
+
+// View-model: last state rendered into each label
+#define LABEL_TEXT_LEN 40
+struct LabelState {
+    char text[LABEL_TEXT_LEN];
+    uint32_t color;
+    const lv_font_t* font;
+    bool valid;  // False until the first update pushes every property
+};
+
+struct TileState {
+    LabelState day;
+    LabelState temp;
+    LabelState desc;
+};
+
+static TileState renderedTiles[3];
+
+void createUI() {
+    screen = lv_scr_act();
+    lv_obj_set_style_bg_color(screen, lv_color_hex(0x000000), 0);
+    
+    // Title (used for status messages during startup)
+    title_label = lv_label_create(screen);
+    lv_label_set_text(title_label, "Weather Station");
+    lv_obj_set_style_text_color(title_label, lv_color_hex(0x00FFFF), 0);
+    lv_obj_set_style_text_font(title_label, &lv_font_montserrat_14, 0);
+    lv_obj_align(title_label, LV_ALIGN_CENTER, 0, 0);
+    
+    // Create 3 horizontal weather tiles
+    int tile_width = 100;
+    int tile_spacing = 6;
+    int start_x = (320 - (tile_width * 3 + tile_spacing * 2)) / 2;
+    
+    for (int i = 0; i < 3; i++) {
+        int x_pos = start_x + (i * (tile_width + tile_spacing));
+        
+        // Day name label (at top of tile)
+        day_labels[i] = lv_label_create(screen);
+        lv_obj_set_style_text_color(day_labels[i], lv_color_hex(0xFFFFFF), 0);
+        lv_obj_set_style_text_font(day_labels[i], &lv_font_montserrat_12, 0);
+        lv_obj_set_pos(day_labels[i], x_pos, 10);
+        lv_obj_set_width(day_labels[i], tile_width);
+        lv_obj_set_style_text_align(day_labels[i], LV_TEXT_ALIGN_CENTER, 0);
+        
+        // Temperature label (LARGE, moved down slightly)
+        temp_labels[i] = lv_label_create(screen);
+        lv_obj_set_style_text_color(temp_labels[i], lv_color_hex(0xFFFF00), 0);
+        lv_obj_set_style_text_font(temp_labels[i], &lv_font_montserrat_24, 0);
+        lv_obj_set_pos(temp_labels[i], x_pos, 65);
+        lv_obj_set_width(temp_labels[i], tile_width);
+        lv_obj_set_style_text_align(temp_labels[i], LV_TEXT_ALIGN_CENTER, 0);
+        
+        // Description label (near bottom, multi-line, size 18)
+        desc_labels[i] = lv_label_create(screen);
+        lv_obj_set_style_text_color(desc_labels[i], lv_color_hex(0xAAAAAA), 0);
+        lv_obj_set_style_text_font(desc_labels[i], &lv_font_montserrat_18, 0);
+        lv_obj_set_pos(desc_labels[i], x_pos, 120);
+        lv_obj_set_width(desc_labels[i], tile_width);
+        lv_obj_set_style_text_align(desc_labels[i], LV_TEXT_ALIGN_CENTER, 0);
+        lv_label_set_long_mode(desc_labels[i], LV_LABEL_LONG_WRAP);
+    }
+    
+    // Update label - initially hidden, will be used for status messages
+    update_label = lv_label_create(screen);
+    lv_obj_set_style_text_color(update_label, lv_color_hex(0x00FF00), 0);
+    lv_obj_set_style_text_font(update_label, &lv_font_montserrat_14, 0);
+    lv_obj_align(update_label, LV_ALIGN_BOTTOM_MID, 0, -5);
+    lv_obj_add_flag(update_label, LV_OBJ_FLAG_HIDDEN);
+}
+
+// Status messages go in the center until there is weather to show, then
+// in the small bottom label so they don't cover the tiles
+void showStatus(const char* message, bool tilesShown) {
+    lv_obj_t* label = tilesShown ? update_label : title_label;
+    lv_label_set_text(label, message);
+    lv_obj_clear_flag(label, LV_OBJ_FLAG_HIDDEN);
+}
+
+// Push only the label properties that differ from what is already on
+// screen. Every LVGL setter invalidates the label, even for an identical
+// value, so skipping unchanged ones keeps the dirty area small.
+// Returns the number of properties that were updated.
+static int applyLabel(lv_obj_t* label, LabelState& state, const char* text,
+                      uint32_t color, const lv_font_t* font) {
+    int changes = 0;
+    if (!state.valid || strcmp(state.text, text) != 0) {
+        TextBuilder(state.text, sizeof(state.text)).str(text);
+        // The view-model owns the buffer, so LVGL doesn't need its own copy
+        lv_label_set_text_static(label, state.text);
+        changes++;
+    }
+    if (!state.valid || state.color != color) {
+        state.color = color;
+        lv_obj_set_style_text_color(label, lv_color_hex(color), 0);
+        changes++;
+    }
+    if (!state.valid || state.font != font) {
+        state.font = font;
+        lv_obj_set_style_text_font(label, font, 0);
+        changes++;
+    }
+    state.valid = true;
+    return changes;
+}
+
+static void hideLabel(lv_obj_t* label) {
+    if (!lv_obj_has_flag(label, LV_OBJ_FLAG_HIDDEN)) {
+        lv_obj_add_flag(label, LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+// Copy a description with its first letter capitalized
+static void formatDescription(char* out, size_t size, const char* desc) {
+    TextBuilder(out, size).str(desc);
+    if (out[0] != '\0') {
+        out[0] = toupper(out[0]);
+    }
+}
+
+int updateWeatherDisplay(const WeatherSnapshot& weather, time_t now) {
+    // Hide startup and status messages
+    hideLabel(title_label);
+    hideLabel(update_label);
+    
+    // Check if data is stale (older than 2 hours, or restored from flash
+    // and not yet refreshed)
+    bool isStale = weather.restored || (now - weather.fetchedAt) > STALE_AFTER_SEC;
+    
+    int changes = 0;
+    for (int i = 0; i < 3; i++) {
+        TileState& tile = renderedTiles[i];
+        const WeatherDay& day = weather.forecast[i];
+        char text[LABEL_TEXT_LEN];
+
+        // Day 0: Show current temp instead of day/date
+        // Days 1-2: Show day name and date
+        if (i == 0) {
+            // Current temperature displayed where day/date usually goes
+            // Cyan for current, larger than temps
+            TextBuilder(text, sizeof(text)).degrees(weather.currentTemp).chr('F');
+            changes += applyLabel(day_labels[i], tile.day, text, 0x00FFFF, &lv_font_montserrat_26);
+        } else {
+            // Normal day/date display
+            TextBuilder(text, sizeof(text)).str(day.day_name).chr('\n').str(day.date);
+            changes += applyLabel(day_labels[i], tile.day, text, 0xFFFFFF, &lv_font_montserrat_12);
+        }
+        
+        // Temperature with red asterisk if stale, yellow when fresh
+        TextBuilder temp(text, sizeof(text));
+        if (isStale) temp.chr('*');
+        temp.degrees(day.temp_high).chr('/').degrees(day.temp_low).chr('F');
+        changes += applyLabel(temp_labels[i], tile.temp, text,
+                              isStale ? 0xFF0000 : 0xFFFF00, &lv_font_montserrat_24);
+        
+        // Description
+        if (i == 0) {
+            // Day 0: Show current conditions in cyan to match current temp
+            formatDescription(text, sizeof(text), weather.currentCondition);
+            changes += applyLabel(desc_labels[i], tile.desc, text, 0x00FFFF, &lv_font_montserrat_18);
+        } else {
+            // Days 1-2: Show forecast in gray
+            formatDescription(text, sizeof(text), day.description);
+            changes += applyLabel(desc_labels[i], tile.desc, text, 0xAAAAAA, &lv_font_montserrat_18);
+        }
+    }
+    return changes;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <time.h>
+#include "lvgl.h"
+#include "weather_types.h"
+
+// ========================================
+// Weather UI
+// ========================================
+// The three forecast tiles plus the status labels, and the view-model
+// that keeps label updates minimal. Depends on LVGL only (no Arduino or
+// board code), so the native environment can build and render it into
+// a memory framebuffer; see host/.
+//
+// Everything here must be called from the task that owns LVGL.
+
+#define STALE_AFTER_SEC (2 * 60 * 60)   // Red asterisk after 2 hours
+
+// Create the labels on the active screen
+void createUI();
+
+// Show a message centered while no forecast is on screen (tilesShown
+// false), otherwise in the small bottom label
+void showStatus(const char* message, bool tilesShown);
+
+// Push a forecast into the labels; now is the UTC time used for the
+// stale marker. Returns the number of label properties that changed.
+int updateWeatherDisplay(const WeatherSnapshot& weather, time_t now);
@@ -0,0 +1,153 @@
+#include "wifi_fast_connect.h"
+
+#include "WiFi.h"
+#include <Preferences.h>
+#include "esp_rom_crc.h"
+
+#define WIFI_CACHE_MAGIC 0x57464343  // "WFCC"
+
+// Fixed-size record shared by RTC memory and NVS; crc covers every byte
+// before it
+struct WifiCacheRecord {
+    uint32_t magic;
+    uint32_t ssidCrc;       // Cache is ignored if the credentials change
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t reserved;
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns1;
+    uint32_t dns2;
+    int64_t leaseObtainedAt; // Wall clock of the DHCP lease, 0 if unknown
+    uint32_t crc;
+};
+
+RTC_DATA_ATTR static WifiCacheRecord rtcCache;
+
+static uint32_t credentialsCrc(const char* ssid, const char* password) {
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)ssid, strlen(ssid));
+    return esp_rom_crc32_le(crc, (const uint8_t*)password, strlen(password));
+}
+
+static uint32_t recordCrc(const WifiCacheRecord& rec) {
+    return esp_rom_crc32_le(0, (const uint8_t*)&rec, offsetof(WifiCacheRecord, crc));
+}
+
+static bool recordValid(const WifiCacheRecord& rec, uint32_t ssidCrc) {
+    return rec.magic == WIFI_CACHE_MAGIC && rec.ssidCrc == ssidCrc && rec.crc == recordCrc(rec);
+}
+
+// RTC copy first (survives deep sleep), NVS after a cold boot
+static bool loadCache(WifiCacheRecord& rec, uint32_t ssidCrc) {
+    if (recordValid(rtcCache, ssidCrc)) {
+        rec = rtcCache;
+        return true;
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(WIFI_CACHE_NVS_NAMESPACE, true)) return false;
+    bool ok = prefs.getBytesLength(WIFI_CACHE_NVS_KEY) == sizeof(rec) &&
+              prefs.getBytes(WIFI_CACHE_NVS_KEY, &rec, sizeof(rec)) == sizeof(rec);
+    prefs.end();
+    if (!ok || !recordValid(rec, ssidCrc)) return false;
+
+    rtcCache = rec;
+    return true;
+}
+
+static void saveCache(const WifiCacheRecord& rec) {
+    rtcCache = rec;
+
+    // Only touch flash when the AP or addressing actually changed; the
+    // lease timestamp alone isn't worth a write
+    Preferences prefs;
+    if (!prefs.begin(WIFI_CACHE_NVS_NAMESPACE, false)) return;
+    WifiCacheRecord stored;
+    bool same = prefs.getBytes(WIFI_CACHE_NVS_KEY, &stored, sizeof(stored)) == sizeof(stored) &&
+                memcmp(&stored, &rec, offsetof(WifiCacheRecord, leaseObtainedAt)) == 0;
+    if (!same) {
+        prefs.putBytes(WIFI_CACHE_NVS_KEY, &rec, sizeof(rec));
+    }
+    prefs.end();
+}
+
+static bool waitForConnection(uint32_t timeoutMs) {
+    unsigned long start = millis();
+    while (WiFi.status() != WL_CONNECTED) {
+        if (millis() - start > timeoutMs) return false;
+        delay(10);
+    }
+    return true;
+}
+
+bool connectWiFiFast(const char* ssid, const char* password) {
+    unsigned long start = millis();
+    uint32_t ssidCrc = credentialsCrc(ssid, password);
+
+    // The cache replaces the SDK's own copy of the config in flash
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+
+    const char* path = "scan";
+    bool connected = false;
+
+    WifiCacheRecord cache;
+    if (loadCache(cache, ssidCrc)) {
+        time_t now = time(nullptr);
+        bool leaseFresh = cache.leaseObtainedAt > 0 && now > 100000 &&
+                          now - cache.leaseObtainedAt < WIFI_STATIC_IP_MAX_AGE_SEC;
+        if (leaseFresh) {
+            WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet),
+                        IPAddress(cache.dns1), IPAddress(cache.dns2));
+            path = "static";
+        } else {
+            WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+            path = "direct";
+        }
+        WiFi.begin(ssid, password, cache.channel, cache.bssid, true);
+        connected = waitForConnection(WIFI_FAST_CONNECT_TIMEOUT_MS);
+        if (!connected) {
+            Serial.printf("WiFi: %s connect failed after %lu ms, scanning\n", path, millis() - start);
+            WiFi.disconnect();
+            path = "scan";
+        }
+    }
+
+    if (!connected) {
+        WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);  // Back to DHCP
+        WiFi.begin(ssid, password);
+        connected = waitForConnection(WIFI_SCAN_CONNECT_TIMEOUT_MS);
+    }
+
+    if (!connected) {
+        Serial.printf("WiFi: connect failed after %lu ms\n", millis() - start);
+        return false;
+    }
+    Serial.printf("WiFi: connected via %s path in %lu ms (ch %d, %s)\n",
+                  path, millis() - start, WiFi.channel(), WiFi.localIP().toString().c_str());
+
+    WifiCacheRecord fresh;
+    memset(&fresh, 0, sizeof(fresh));
+    fresh.magic = WIFI_CACHE_MAGIC;
+    fresh.ssidCrc = ssidCrc;
+    memcpy(fresh.bssid, WiFi.BSSID(), sizeof(fresh.bssid));
+    fresh.channel = WiFi.channel();
+    fresh.ip = WiFi.localIP();
+    fresh.gateway = WiFi.gatewayIP();
+    fresh.subnet = WiFi.subnetMask();
+    fresh.dns1 = WiFi.dnsIP(0);
+    fresh.dns2 = WiFi.dnsIP(1);
+    // A static-IP connect doesn't renew the lease, so keep its old date.
+    // Unknown (0) before the first NTP sync; the next connect fills it in.
+    time_t now = time(nullptr);
+    if (strcmp(path, "static") == 0) {
+        fresh.leaseObtainedAt = cache.leaseObtainedAt;
+    } else {
+        fresh.leaseObtainedAt = now > 100000 ? now : 0;
+    }
+    fresh.crc = recordCrc(fresh);
+    saveCache(fresh);
+
+    return true;
+}
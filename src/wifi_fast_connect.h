@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Arduino.h"
+
+// ========================================
+// Fast WiFi Reconnect
+// ========================================
+// After the first successful association the AP's BSSID and channel and
+// the DHCP-assigned addresses are cached in RTC memory (deep-sleep wakes)
+// and NVS (cold boots). Later connects try, in order:
+//   static - cached AP + channel, cached IP (no scan, no DHCP)
+//   direct - cached AP + channel, DHCP (no scan)
+//   scan   - full scan and associate, as before
+// The static-IP path is only used while the cached lease is recent and
+// the wall clock is known, so an expired lease can't cause a conflict.
+
+#ifndef WIFI_FAST_CONNECT_TIMEOUT_MS
+#define WIFI_FAST_CONNECT_TIMEOUT_MS  3000
+#endif
+#ifndef WIFI_SCAN_CONNECT_TIMEOUT_MS
+#define WIFI_SCAN_CONNECT_TIMEOUT_MS  15000
+#endif
+#ifndef WIFI_STATIC_IP_MAX_AGE_SEC
+#define WIFI_STATIC_IP_MAX_AGE_SEC    (12 * 60 * 60)  // Well inside typical leases
+#endif
+#define WIFI_CACHE_NVS_NAMESPACE      "wifi"
+#define WIFI_CACHE_NVS_KEY            "cache"
+
+// Connect in station mode using the fastest path that works, and refresh
+// the cache on success. Logs which path succeeded and how long it took.
+bool connectWiFiFast(const char* ssid, const char* password);
@@ -1,13 +1,19 @@
 #pragma once
 
-#include "WString.h"
+#include <stddef.h>
+#include <string.h>
 
+// IANA zone name -> POSIX TZ string. The table is constexpr and holds
+// only pointers to string literals, so it lives entirely in flash: no
+// static-init constructors and no heap copies. Entries must stay sorted
+// by name (byte order) for lookupPosixTz(); a static_assert below
+// checks that at compile time.
 typedef struct {
-  String name;
-  String zones;
+  const char* name;
+  const char* zones;
 } zones_t;
 
-const zones_t zones[] = {
+constexpr zones_t zones[] = {
     {"Africa/Abidjan", "GMT0"},
     {"Africa/Accra", "GMT0"},
     {"Africa/Addis_Ababa", "EAT-3"},
@@ -192,7 +198,7 @@ const zones_t zones[] = {
     {"America/Scoresbysund", "<-01>1<+00>,M3.5.0/0,M10.5.0/1"},
     {"America/Sitka", "AKST9AKDT,M3.2.0,M11.1.0"},
     {"America/St_Barthelemy", "AST4"},
-    {"America/St_Johns", "NST3,30NDT,M3.2.0,M11.1.0"},
+    {"America/St_Johns", "NST3:30NDT,M3.2.0,M11.1.0"},
     {"America/St_Kitts", "AST4"},
     {"America/St_Lucia", "AST4"},
     {"America/St_Thomas", "AST4"},
@@ -239,7 +245,7 @@ const zones_t zones[] = {
     {"Asia/Brunei", "<+08>-8"},
     {"Asia/Chita", "<+09>-9"},
     {"Asia/Choibalsan", "<+08>-8"},
-    {"Asia/Colombo", "<+0530>-5,30"},
+    {"Asia/Colombo", "<+0530>-5:30"},
     {"Asia/Damascus", "<+03>-3"},
     {"Asia/Dhaka", "<+06>-6"},
     {"Asia/Dili", "<+09>-9"},
@@ -255,12 +261,12 @@ const zones_t zones[] = {
     {"Asia/Jakarta", "WIB-7"},
     {"Asia/Jayapura", "WIT-9"},
     {"Asia/Jerusalem", "IST-2IDT,M3.4.4/26,M10.5.0"},
-    {"Asia/Kabul", "<+0430>-4,30"},
+    {"Asia/Kabul", "<+0430>-4:30"},
     {"Asia/Kamchatka", "<+12>-12"},
     {"Asia/Karachi", "PKT-5"},
-    {"Asia/Kathmandu", "<+0545>-5,45"},
+    {"Asia/Kathmandu", "<+0545>-5:45"},
     {"Asia/Khandyga", "<+09>-9"},
-    {"Asia/Kolkata", "IST-5,30"},
+    {"Asia/Kolkata", "IST-5:30"},
     {"Asia/Krasnoyarsk", "<+07>-7"},
     {"Asia/Kuala_Lumpur", "<+08>-8"},
     {"Asia/Kuching", "<+08>-8"},
@@ -290,7 +296,7 @@ const zones_t zones[] = {
     {"Asia/Taipei", "CST-8"},
     {"Asia/Tashkent", "<+05>-5"},
     {"Asia/Tbilisi", "<+04>-4"},
-    {"Asia/Tehran", "<+0330>-3,30"},
+    {"Asia/Tehran", "<+0330>-3:30"},
     {"Asia/Thimphu", "<+06>-6"},
     {"Asia/Tokyo", "JST-9"},
     {"Asia/Tomsk", "<+07>-7"},
@@ -300,7 +306,7 @@ const zones_t zones[] = {
     {"Asia/Vientiane", "<+07>-7"},
     {"Asia/Vladivostok", "<+10>-10"},
     {"Asia/Yakutsk", "<+09>-9"},
-    {"Asia/Yangon", "<+0630>-6,30"},
+    {"Asia/Yangon", "<+0630>-6:30"},
     {"Asia/Yekaterinburg", "<+05>-5"},
     {"Asia/Yerevan", "<+04>-4"},
     {"Atlantic/Azores", "<-01>1<+00>,M3.5.0/0,M10.5.0/1"},
@@ -313,15 +319,15 @@ const zones_t zones[] = {
     {"Atlantic/South_Georgia", "<-02>2"},
     {"Atlantic/St_Helena", "GMT0"},
     {"Atlantic/Stanley", "<-03>3"},
-    {"Australia/Adelaide", "ACST-9,30ACDT,M10.1.0,M4.1.0/3"},
+    {"Australia/Adelaide", "ACST-9:30ACDT,M10.1.0,M4.1.0/3"},
     {"Australia/Brisbane", "AEST-10"},
-    {"Australia/Broken_Hill", "ACST-9,30ACDT,M10.1.0,M4.1.0/3"},
+    {"Australia/Broken_Hill", "ACST-9:30ACDT,M10.1.0,M4.1.0/3"},
     {"Australia/Currie", "AEST-10AEDT,M10.1.0,M4.1.0/3"},
-    {"Australia/Darwin", "ACST-9,30"},
-    {"Australia/Eucla", "<+0845>-8,45"},
+    {"Australia/Darwin", "ACST-9:30"},
+    {"Australia/Eucla", "<+0845>-8:45"},
     {"Australia/Hobart", "AEST-10AEDT,M10.1.0,M4.1.0/3"},
     {"Australia/Lindeman", "AEST-10"},
-    {"Australia/Lord_Howe", "<+1030>-10,30<+11>-11,M10.1.0,M4.1.0"},
+    {"Australia/Lord_Howe", "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0"},
     {"Australia/Melbourne", "AEST-10AEDT,M10.1.0,M4.1.0/3"},
     {"Australia/Perth", "AWST-8"},
     {"Australia/Sydney", "AEST-10AEDT,M10.1.0,M4.1.0/3"},
@@ -423,7 +429,7 @@ const zones_t zones[] = {
     {"Indian/Antananarivo", "EAT-3"},
     {"Indian/Chagos", "<+06>-6"},
     {"Indian/Christmas", "<+07>-7"},
-    {"Indian/Cocos", "<+0630>-6,30"},
+    {"Indian/Cocos", "<+0630>-6:30"},
     {"Indian/Comoro", "EAT-3"},
     {"Indian/Kerguelen", "<+05>-5"},
     {"Indian/Mahe", "<+04>-4"},
@@ -434,7 +440,7 @@ const zones_t zones[] = {
     {"Pacific/Apia", "<+13>-13"},
     {"Pacific/Auckland", "NZST-12NZDT,M9.5.0,M4.1.0/3"},
     {"Pacific/Bougainville", "<+11>-11"},
-    {"Pacific/Chatham", "<+1245>-12,45<+1345>,M9.5.0/2,45,M4.1.0/3,45"},
+    {"Pacific/Chatham", "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45"},
     {"Pacific/Chuuk", "<+10>-10"},
     {"Pacific/Easter", "<-06>6<-05>,M9.1.6/22,M4.1.6/22"},
     {"Pacific/Efate", "<+11>-11"},
@@ -451,7 +457,7 @@ const zones_t zones[] = {
     {"Pacific/Kosrae", "<+11>-11"},
     {"Pacific/Kwajalein", "<+12>-12"},
     {"Pacific/Majuro", "<+12>-12"},
-    {"Pacific/Marquesas", "<-0930>9,30"},
+    {"Pacific/Marquesas", "<-0930>9:30"},
     {"Pacific/Midway", "SST11"},
     {"Pacific/Nauru", "<+12>-12"},
     {"Pacific/Niue", "<-11>11"},
@@ -469,4 +475,38 @@ const zones_t zones[] = {
     {"Pacific/Tongatapu", "<+13>-13"},
     {"Pacific/Wake", "<+12>-12"},
     {"Pacific/Wallis", "<+12>-12"},
-};
\ No newline at end of file
+};
+
+constexpr size_t ZONES_COUNT = sizeof(zones) / sizeof(zones[0]);
+
+constexpr int zoneNameCompare(const char* a, const char* b) {
+  return (*a != *b || *a == '\0') ? (int)(unsigned char)*a - (int)(unsigned char)*b
+                                  : zoneNameCompare(a + 1, b + 1);
+}
+
+// Checks [lo, hi) by halves that overlap by one entry, keeping the
+// recursion depth logarithmic
+constexpr bool zonesSorted(size_t lo, size_t hi) {
+  return hi - lo < 2 ? true
+       : hi - lo == 2 ? zoneNameCompare(zones[lo].name, zones[lo + 1].name) < 0
+       : zonesSorted(lo, lo + (hi - lo) / 2 + 1) && zonesSorted(lo + (hi - lo) / 2, hi);
+}
+
+static_assert(zonesSorted(0, ZONES_COUNT), "zones[] must be sorted by name");
+
+// POSIX TZ string for an IANA zone name, or nullptr if unknown. O(log n).
+inline const char* lookupPosixTz(const char* name) {
+  size_t lo = 0;
+  size_t hi = ZONES_COUNT;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    int cmp = strcmp(name, zones[mid].name);
+    if (cmp == 0) return zones[mid].zones;
+    if (cmp < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return nullptr;
+}
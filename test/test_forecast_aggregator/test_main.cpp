@@ -0,0 +1,208 @@
+// ========================================
+// Forecast Aggregation Test (native)
+// ========================================
+// Runs the recorded OWM forecast (tools/mock_responses/forecast.json)
+// through ForecastAggregator and through the per-day loop it replaced
+// (gmtime/strftime per entry, dates and descriptions compared as
+// strings; std::string stands in for Arduino String). Both must group
+// the days the same way, and the benchmark times the two.
+//
+// pio test runs the program from the project directory, which is where
+// the recording is looked up; the test exits before running any case if
+// it can't be read.
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <time.h>
+#include <unity.h>
+#include "ArduinoJson.h"
+#include "forecast_aggregator.h"
+#include "text_format.h"
+
+#define FORECAST_JSON  "tools/mock_responses/forecast.json"
+#define MAX_ENTRIES    40
+#define BENCH_ROUNDS   2000
+
+struct Entry {
+    int64_t dt;
+    float temp;
+    int humidity;
+    char description[FORECAST_DESC_LEN];
+};
+
+static Entry entries[MAX_ENTRIES];
+static int entryCount = 0;
+static int32_t utcOffset = 0;
+static int64_t nowUtc = 0;
+
+// What the old loop produced per day
+struct OldDay {
+    float high;
+    float low;
+    int humidity;
+    std::string description;
+    std::string date;     // YYYY-MM-DD
+};
+
+static bool loadForecast() {
+    FILE* file = fopen(FORECAST_JSON, "rb");
+    if (!file) return false;
+    std::string json;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) json.append(buf, n);
+    fclose(file);
+
+    JsonDocument doc;
+    if (deserializeJson(doc, json)) return false;
+    utcOffset = doc["city"]["timezone"].as<int32_t>();
+    for (JsonObject item : doc["list"].as<JsonArray>()) {
+        if (entryCount == MAX_ENTRIES) break;
+        Entry& e = entries[entryCount++];
+        e.dt = item["dt"].as<int64_t>();
+        e.temp = item["main"]["temp"].as<float>();
+        e.humidity = item["main"]["humidity"].as<int>();
+        strncpy(e.description, item["weather"][0]["description"] | "", FORECAST_DESC_LEN - 1);
+        e.description[FORECAST_DESC_LEN - 1] = '\0';
+    }
+    // An hour before the first entry: today is the first entry's date
+    if (entryCount > 0) nowUtc = entries[0].dt - 3600;
+    return entryCount > 0;
+}
+
+// The grouping loop from fetchWeatherData() before ForecastAggregator
+static void oldLoop(OldDay days[3]) {
+    time_t localTime = (time_t)(nowUtc + utcOffset);
+    struct tm timeinfo;
+    gmtime_r(&localTime, &timeinfo);
+    char currentDate[11];
+    strftime(currentDate, sizeof(currentDate), "%Y-%m-%d", &timeinfo);
+
+    float dayHighs[3] = {-999, -999, -999};
+    float dayLows[3] = {999, 999, 999};
+    std::string dayDescriptions[3] = {"", "", ""};
+    std::string dayDates[3] = {"", "", ""};
+    int dayHumiditySums[3] = {0, 0, 0};
+    int dayHumidityCounts[3] = {0, 0, 0};
+
+    for (int i = 0; i < entryCount; i++) {
+        const Entry& item = entries[i];
+        time_t forecast_time = (time_t)(item.dt + utcOffset);
+        struct tm forecast_tm;
+        gmtime_r(&forecast_time, &forecast_tm);
+        char forecastDate[11];
+        strftime(forecastDate, sizeof(forecastDate), "%Y-%m-%d", &forecast_tm);
+        char forecastTime[6];
+        strftime(forecastTime, sizeof(forecastTime), "%H:%M", &forecast_tm);
+
+        int dayIndex = -1;
+        if (strcmp(forecastDate, currentDate) == 0) {
+            dayIndex = 0;
+        } else if (dayDates[1] == "" || dayDates[1] == forecastDate) {
+            dayIndex = 1;
+            if (dayDates[1] == "") dayDates[1] = forecastDate;
+        } else if (dayDates[2] == "" || dayDates[2] == forecastDate) {
+            dayIndex = 2;
+            if (dayDates[2] == "") dayDates[2] = forecastDate;
+        } else {
+            continue;
+        }
+        if (dayDates[dayIndex] == "") {
+            dayDates[dayIndex] = forecastDate;
+        }
+
+        float temp = item.temp;
+        if (temp > dayHighs[dayIndex]) dayHighs[dayIndex] = temp;
+        if (temp < dayLows[dayIndex]) dayLows[dayIndex] = temp;
+        dayHumiditySums[dayIndex] += item.humidity;
+        dayHumidityCounts[dayIndex]++;
+
+        if (dayDescriptions[dayIndex] == "" ||
+            (strcmp(forecastTime, "12:00") >= 0 && strcmp(forecastTime, "15:00") <= 0)) {
+            dayDescriptions[dayIndex] = item.description;
+        }
+    }
+
+    dayDates[0] = currentDate;
+    for (int day = 0; day < 3; day++) {
+        days[day].high = dayHighs[day];
+        days[day].low = dayLows[day];
+        days[day].humidity =
+            dayHumidityCounts[day] ? dayHumiditySums[day] / dayHumidityCounts[day] : 0;
+        days[day].description = dayDescriptions[day];
+        days[day].date = dayDates[day];
+    }
+}
+
+static void aggregate(ForecastAggregator& aggregator) {
+    aggregator.begin(nowUtc, utcOffset);
+    for (int i = 0; i < entryCount; i++) {
+        const Entry& e = entries[i];
+        aggregator.add(e.dt, utcOffset, tenthsFromFloat(e.temp), e.humidity, e.description);
+    }
+    aggregator.finish();
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_same_days_as_the_old_loop() {
+    OldDay old[3];
+    oldLoop(old);
+    ForecastAggregator aggregator;
+    aggregate(aggregator);
+
+    for (int i = 0; i < 3; i++) {
+        const DayAccumulator& day = aggregator.day(i);
+        CivilDate civil = civilFromDayNumber(day.dayNumber);
+        char date[16];
+        snprintf(date, sizeof(date), "%04d-%02d-%02d", (int)civil.year, civil.month, civil.day);
+        TEST_ASSERT_EQUAL_STRING(old[i].date.c_str(), date);
+        TEST_ASSERT_EQUAL_INT(tenthsFromFloat(old[i].high), day.tempHigh);
+        TEST_ASSERT_EQUAL_INT(tenthsFromFloat(old[i].low), day.tempLow);
+        TEST_ASSERT_EQUAL_INT(old[i].humidity, aggregator.averageHumidity(i));
+        TEST_ASSERT_EQUAL_STRING(old[i].description.c_str(), day.description);
+    }
+}
+
+void test_benchmark_against_the_old_loop() {
+    typedef std::chrono::steady_clock Clock;
+    long checksum[2] = {0, 0};
+
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        OldDay old[3];
+        oldLoop(old);
+        checksum[0] += tenthsFromFloat(old[2].high);
+    }
+    double oldUs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       Clock::now() - start).count() / 1000.0 / BENCH_ROUNDS;
+
+    start = Clock::now();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        ForecastAggregator aggregator;
+        aggregate(aggregator);
+        checksum[1] += aggregator.day(2).tempHigh;
+    }
+    double newUs = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       Clock::now() - start).count() / 1000.0 / BENCH_ROUNDS;
+
+    printf("%d entries: old loop %.2f us, ForecastAggregator %.2f us (%.1fx)\n", entryCount,
+           oldUs, newUs, oldUs / newUs);
+    TEST_ASSERT_TRUE(checksum[0] == checksum[1]);
+}
+
+int main(int argc, char** argv) {
+    // Every case needs the recording; without it there is nothing to compare
+    if (!loadForecast()) {
+        fprintf(stderr, "can't read %s (run from the project directory)\n", FORECAST_JSON);
+        return 1;
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_same_days_as_the_old_loop);
+    RUN_TEST(test_benchmark_against_the_old_loop);
+    return UNITY_END();
+}
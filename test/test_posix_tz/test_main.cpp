@@ -0,0 +1,97 @@
+// ========================================
+// POSIX TZ Engine Test (native)
+// ========================================
+// Checks the rule engine against glibc, which implements the same POSIX
+// TZ format: every zone in zones.h, over 2024-2029, with the same
+// transition window the refresh uses (a day back, six days ahead).
+// Offsets are compared hourly and one second either side of every
+// transition the cache computed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unity.h>
+#include "posix_tz.h"
+#include "zones.h"
+
+#define FROM_UTC   1704067200LL   // 2024-01-01
+#define TO_UTC     1893456000LL   // 2030-01-01
+#define DAY        86400LL
+#define WINDOW     (7 * DAY)
+
+static int mismatches = 0;
+
+static int32_t glibcOffset(int64_t utc) {
+    time_t t = (time_t)utc;
+    struct tm local;
+    localtime_r(&t, &local);
+    return (int32_t)local.tm_gmtoff;
+}
+
+static void check(const char* name, const char* spec, TzTransitionCache& cache, int64_t utc) {
+    int32_t expected = glibcOffset(utc);
+    int32_t actual = cache.offsetAt(utc);
+    if (actual == expected) return;
+    if (mismatches < 10) {
+        printf("%s \"%s\" at %lld: glibc %ld, engine %ld\n", name, spec, (long long)utc,
+               (long)expected, (long)actual);
+    }
+    mismatches++;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_every_zone_parses() {
+    for (size_t i = 0; i < ZONES_COUNT; i++) {
+        PosixTz tz;
+        TEST_ASSERT_TRUE_MESSAGE(parsePosixTz(zones[i].zones, tz), zones[i].name);
+    }
+}
+
+void test_every_zone_matches_glibc() {
+    mismatches = 0;
+    for (size_t i = 0; i < ZONES_COUNT; i++) {
+        const char* spec = zones[i].zones;
+        PosixTz tz;
+        if (!parsePosixTz(spec, tz)) continue;   // Reported above
+        setenv("TZ", spec, 1);
+        tzset();
+
+        for (int64_t start = FROM_UTC; start < TO_UTC; start += WINDOW) {
+            TzTransitionCache cache;
+            cache.build(tz, start - DAY, start + WINDOW - DAY);
+            for (int64_t utc = start - DAY; utc < start + WINDOW - DAY; utc += 3600) {
+                check(zones[i].name, spec, cache, utc);
+                int32_t offset = cache.offsetAt(utc);
+                if (cache.offsetAt(utc + 3600) == offset) continue;
+
+                // A transition within the next hour: find its second and
+                // check both sides of it
+                int64_t lo = utc;
+                int64_t hi = utc + 3600;
+                while (hi - lo > 1) {
+                    int64_t mid = lo + (hi - lo) / 2;
+                    if (cache.offsetAt(mid) == offset) {
+                        lo = mid;
+                    } else {
+                        hi = mid;
+                    }
+                }
+                check(zones[i].name, spec, cache, lo);
+                check(zones[i].name, spec, cache, hi);
+            }
+        }
+    }
+    unsetenv("TZ");
+    tzset();
+    printf("%u zones, 2024-2029: %d mismatches\n", (unsigned)ZONES_COUNT, mismatches);
+    TEST_ASSERT_EQUAL_INT(0, mismatches);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_zone_parses);
+    RUN_TEST(test_every_zone_matches_glibc);
+    return UNITY_END();
+}
@@ -0,0 +1,165 @@
+// ========================================
+// Render Allocation Test (native)
+// ========================================
+// A weather refresh must not touch the heap once the screen has been
+// built. Each case runs the refresh path from a fetched report onwards:
+// ForecastAggregator over the recorded forecast
+// (tools/mock_responses/forecast.json), fillForecastDays() into the
+// snapshot, updateWeatherDisplay() and a full lv_refr_now(). lv_conf.h
+// routes LVGL's allocator to malloc/realloc (LV_MEM_CUSTOM), so counting
+// those calls covers LVGL too. Interposes glibc's malloc, so it runs on
+// Linux.
+//
+// Parsing the recording allocates (ArduinoJson), as does LVGL the first
+// time it draws each style; both happen in main() before any case runs.
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unity.h>
+#include "ArduinoJson.h"
+#include "lvgl.h"
+#include "Arduino.h"
+#include "forecast_aggregator.h"
+#include "text_format.h"
+#include "weather_ui.h"
+#include "framebuffer_display.h"
+
+#define FORECAST_JSON  "tools/mock_responses/forecast.json"
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static bool counting = false;
+static unsigned allocCalls = 0;
+
+extern "C" void* malloc(size_t size) {
+    if (counting) allocCalls++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (counting) allocCalls++;
+    return __libc_realloc(ptr, size);
+}
+
+static WeatherReport report;
+static WeatherSnapshot weather;
+
+// Fill the report the way OwmProvider does from the forecast response
+static bool loadForecast() {
+    FILE* file = fopen(FORECAST_JSON, "rb");
+    if (!file) return false;
+    std::string json;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), file)) > 0) json.append(buf, n);
+    fclose(file);
+
+    JsonDocument doc;
+    if (deserializeJson(doc, json)) return false;
+    memset(&report, 0, sizeof(report));
+    report.utcOffset = doc["city"]["timezone"].as<int32_t>();
+    for (JsonObject item : doc["list"].as<JsonArray>()) {
+        if (report.hourlyCount == WEATHER_HOURLY_MAX) break;
+        HourlyPoint& point = report.hourly[report.hourlyCount++];
+        point.dt = item["dt"].as<int64_t>();
+        point.temp = tenthsFromFloat(item["main"]["temp"].as<float>());
+        point.humidity = item["main"]["humidity"].as<uint8_t>();
+        strncpy(point.description, item["weather"][0]["description"] | "",
+                sizeof(point.description) - 1);
+    }
+    if (report.hourlyCount == 0) return false;
+    report.currentTemp = report.hourly[0].temp;
+    strncpy(report.currentCondition, report.hourly[0].description,
+            sizeof(report.currentCondition) - 1);
+
+    // Fetched an hour before the first entry: today is its date
+    memset(&weather, 0, sizeof(weather));
+    weather.fetchedAt = (time_t)(report.hourly[0].dt - 3600);
+    return true;
+}
+
+// Allocations made by one refresh, shown at the given wall clock time:
+// aggregation, snapshot fill, label update and a full render
+static unsigned refreshAllocations(time_t now) {
+    allocCalls = 0;
+    counting = true;
+
+    ForecastAggregator aggregator;
+    aggregator.begin(weather.fetchedAt, report.utcOffset);
+    for (int i = 0; i < report.hourlyCount; i++) {
+        const HourlyPoint& point = report.hourly[i];
+        aggregator.add(point.dt, report.utcOffset, point.temp, point.humidity,
+                       point.description);
+    }
+    aggregator.finish();
+    weather.currentTemp = report.currentTemp;
+    memcpy(weather.currentCondition, report.currentCondition, sizeof(weather.currentCondition));
+    weather.timezoneOffset = report.utcOffset;
+    fillForecastDays(aggregator, report.daily, report.dailyCount, weather.currentTemp,
+                     weather.forecast);
+
+    updateWeatherDisplay(weather, now);
+    lv_refr_now(NULL);
+    counting = false;
+    fakeClockAdvance(1000);
+    return allocCalls;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_identical_refresh_allocates_nothing() {
+    TEST_ASSERT_EQUAL_UINT(0, refreshAllocations(weather.fetchedAt + 60));
+}
+
+void test_new_temperatures_allocate_nothing() {
+    for (int i = 0; i < report.hourlyCount; i++) {
+        report.hourly[i].temp += 16;
+    }
+    report.currentTemp -= 35;
+    TEST_ASSERT_EQUAL_UINT(0, refreshAllocations(weather.fetchedAt + 120));
+}
+
+void test_new_description_allocates_nothing() {
+    for (int i = 0; i < report.hourlyCount; i++) {
+        strncpy(report.hourly[i].description, "thunderstorm with rain",
+                sizeof(report.hourly[i].description) - 1);
+    }
+    strncpy(report.currentCondition, "thunderstorm with rain",
+            sizeof(report.currentCondition) - 1);
+    TEST_ASSERT_EQUAL_UINT(0, refreshAllocations(weather.fetchedAt + 180));
+}
+
+void test_stale_toggle_allocates_nothing() {
+    TEST_ASSERT_EQUAL_UINT(0, refreshAllocations(weather.fetchedAt + STALE_AFTER_SEC + 1));
+    TEST_ASSERT_EQUAL_UINT(0, refreshAllocations(weather.fetchedAt + 240));
+}
+
+int main(int argc, char** argv) {
+    // Every case refreshes from the recording
+    if (!loadForecast()) {
+        fprintf(stderr, "can't read %s (run from the project directory)\n", FORECAST_JSON);
+        return 1;
+    }
+
+    lv_init();
+    framebufferInit();
+    createUI();
+    lv_refr_now(NULL);
+
+    // Styles and LVGL's scratch buffers are allocated on first use: go
+    // through a fresh and a stale render once before counting
+    refreshAllocations(weather.fetchedAt);
+    refreshAllocations(weather.fetchedAt + STALE_AFTER_SEC + 1);
+    refreshAllocations(weather.fetchedAt);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_identical_refresh_allocates_nothing);
+    RUN_TEST(test_new_temperatures_allocate_nothing);
+    RUN_TEST(test_new_description_allocates_nothing);
+    RUN_TEST(test_stale_toggle_allocates_nothing);
+    return UNITY_END();
+}
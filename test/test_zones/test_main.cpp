@@ -0,0 +1,79 @@
+// ========================================
+// Zone Table Test (native)
+// ========================================
+// lookupPosixTz() must find every entry of zones.h and nothing else. The
+// benchmark times it against a plain linear scan of the same table,
+// looking up every zone in turn.
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "zones.h"
+
+#define BENCH_ROUNDS 200
+
+static const char* linearLookup(const char* name) {
+    for (size_t i = 0; i < ZONES_COUNT; i++) {
+        if (strcmp(name, zones[i].name) == 0) return zones[i].zones;
+    }
+    return nullptr;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_every_entry_is_found() {
+    for (size_t i = 0; i < ZONES_COUNT; i++) {
+        TEST_ASSERT_EQUAL_PTR_MESSAGE(zones[i].zones, lookupPosixTz(zones[i].name),
+                                      zones[i].name);
+    }
+}
+
+void test_unknown_names_return_null() {
+    static const char* const unknown[] = {
+        "",
+        "Mars/Olympus_Mons",
+        "America/Chicag",       // Prefix of an entry
+        "America/Chicago/",     // An entry plus one character
+        "america/chicago",      // Names are case sensitive
+        " America/Chicago",
+        "A",                    // Sorts before the first entry
+        "~",                    // ...and after the last
+    };
+    for (size_t i = 0; i < sizeof(unknown) / sizeof(unknown[0]); i++) {
+        TEST_ASSERT_NULL(lookupPosixTz(unknown[i]));
+    }
+}
+
+void test_benchmark_against_linear_scan() {
+    typedef std::chrono::steady_clock Clock;
+    uintptr_t check[2] = {0, 0};
+    double nsPerLookup[2];
+    const char* (*const lookups[2])(const char*) = {linearLookup, lookupPosixTz};
+
+    for (int method = 0; method < 2; method++) {
+        Clock::time_point start = Clock::now();
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            for (size_t i = 0; i < ZONES_COUNT; i++) {
+                check[method] += (uintptr_t)lookups[method](zones[i].name);
+            }
+        }
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - start).count();
+        nsPerLookup[method] = ns / ((double)BENCH_ROUNDS * ZONES_COUNT);
+    }
+
+    printf("%u zones: linear scan %.1f ns/lookup, binary search %.1f ns/lookup (%.1fx)\n",
+           (unsigned)ZONES_COUNT, nsPerLookup[0], nsPerLookup[1],
+           nsPerLookup[0] / nsPerLookup[1]);
+    TEST_ASSERT_TRUE(check[0] == check[1]);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_entry_is_found);
+    RUN_TEST(test_unknown_names_return_null);
+    RUN_TEST(test_benchmark_against_linear_scan);
+    return UNITY_END();
+}
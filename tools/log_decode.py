@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Turn a binary log capture (LOG_BINARY_OUTPUT=1) back into text.
+
+Each record holds the address of its format string, not the string, so
+the decoder needs the firmware ELF the capture came from:
+
+    pio device monitor --raw > capture.bin        (or any raw serial capture)
+    python3 tools/log_decode.py .pio/build/lilygo-t-display-s3/firmware.elf capture.bin
+
+Bytes that aren't a valid record (boot messages, output of code that
+still uses Serial.printf) are passed through as text. See
+src/deferred_log.h for the record layout.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+RECORD_MARKER = 0xA5
+HEADER_BYTES = 12
+MAX_RECORD = 160
+LEVELS = {1: "E", 2: "W", 3: "I", 4: "D"}
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+SPEC = re.compile(r"%(%|[-+ #0-9.]*[hlLqjzt]*([diouxXcsfFeEgGaAp]))")
+
+
+class Elf:
+    """Just enough ELF to read strings from the loaded sections."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        d = self.data
+        if d[:4] != b"\x7fELF" or d[5] != 1:
+            sys.exit("%s: not a little-endian ELF file" % path)
+        if d[4] == 1:   # ELF32
+            shoff, = struct.unpack_from("<I", d, 0x20)
+            shentsize, shnum = struct.unpack_from("<HH", d, 0x2E)
+            layout, fields = "<IIIIIIIIII", (1, 2, 3, 4, 5)
+        else:           # ELF64, e.g. a host build
+            shoff, = struct.unpack_from("<Q", d, 0x28)
+            shentsize, shnum = struct.unpack_from("<HH", d, 0x3A)
+            layout, fields = "<IIQQQQIIQQ", (1, 2, 3, 4, 5)
+        self.sections = []
+        for i in range(shnum):
+            sh = struct.unpack_from(layout, d, shoff + i * shentsize)
+            sh_type, flags, addr, offset, size = (sh[j] for j in fields)
+            if flags & SHF_ALLOC and sh_type != SHT_NOBITS and size:
+                self.sections.append((addr, offset, size))
+        self.cache = {}
+
+    def string_at(self, addr):
+        if addr in self.cache:
+            return self.cache[addr]
+        text = None
+        for base, offset, size in self.sections:
+            if base <= addr < base + size:
+                start = offset + addr - base
+                end = self.data.find(b"\0", start, offset + size)
+                if end >= 0:
+                    text = self.data[start:end].decode("utf-8", "replace")
+                break
+        self.cache[addr] = text
+        return text
+
+
+def parse_args(payload):
+    """Tagged arguments -> list, or None if the record is malformed."""
+    args, i = [], 0
+    while i < len(payload):
+        tag = payload[i]
+        i += 1
+        if tag == 0:
+            return args
+        if tag == ord("i"):
+            args.append(("i", struct.unpack_from("<i", payload, i)[0]))
+            i += 4
+        elif tag == ord("l"):
+            args.append(("l", struct.unpack_from("<q", payload, i)[0]))
+            i += 8
+        elif tag == ord("d"):
+            args.append(("d", struct.unpack_from("<d", payload, i)[0]))
+            i += 8
+        elif tag == ord("s"):
+            n = payload[i]
+            args.append(("s", payload[i + 1:i + 1 + n].decode("utf-8", "replace")))
+            i += 1 + n
+        else:
+            return None
+        if i > len(payload):
+            return None
+    return None
+
+
+def format_record(fmt, args):
+    """printf the way the firmware's drain task does."""
+    values = iter(args)
+
+    def one(match):
+        if match.group(1) == "%":
+            return "%"
+        conv = match.group(2)
+        flags = re.sub(r"[hlLqjzt]", "", match.group(0)[1:-1])
+        tag, value = next(values, (None, None))
+        if tag in ("i", "l") and conv not in "fFeEgGaAs":
+            if conv in "uxXop":
+                value &= 0xFFFFFFFF if tag == "i" else 0xFFFFFFFFFFFFFFFF
+            if conv == "c":
+                return ("%" + flags + "c") % chr(value & 0xFF)
+            return ("%" + flags + {"u": "d", "i": "d", "p": "x"}.get(conv, conv)) % value
+        if tag == "d" and conv in "fFeEgG":
+            return ("%" + flags + conv) % value
+        if tag == "s" and conv == "s":
+            return ("%" + flags + "s") % value
+        return "?"
+
+    return SPEC.sub(one, fmt)
+
+
+def decode(elf, data, out, timestamps):
+    text = bytearray()
+
+    def flush_text():
+        if text:
+            out.write(text.decode("utf-8", "replace"))
+            text.clear()
+
+    pos = 0
+    while pos < len(data):
+        record = None
+        if pos + HEADER_BYTES <= len(data) and data[pos + 3] == RECORD_MARKER:
+            header, fmt_addr, millis = struct.unpack_from("<III", data, pos)
+            size, level = header & 0xFFFF, (header >> 16) & 0xFF
+            if (level in LEVELS and HEADER_BYTES < size <= MAX_RECORD and size % 4 == 0 and
+                    pos + size <= len(data)):
+                fmt = elf.string_at(fmt_addr)
+                args = parse_args(data[pos + HEADER_BYTES:pos + size]) if fmt is not None else None
+                if args is not None:
+                    record = (size, level, millis, fmt, args)
+        if record is None:
+            text.append(data[pos])
+            pos += 1
+            continue
+
+        flush_text()
+        size, level, millis, fmt, args = record
+        line = format_record(fmt, args)
+        if timestamps:
+            line = "[%9.3f %s] %s" % (millis / 1000.0, LEVELS[level], line)
+        out.write(line)
+        pos += size
+    flush_text()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("elf", help="firmware ELF the capture was made with")
+    parser.add_argument("capture", nargs="?", help="raw capture (default: stdin)")
+    parser.add_argument("-t", "--timestamps", action="store_true",
+                        help="prefix records with millis() and level")
+    opts = parser.parse_args()
+
+    elf = Elf(opts.elf)
+    if opts.capture:
+        with open(opts.capture, "rb") as f:
+            data = f.read()
+    else:
+        data = sys.stdin.buffer.read()
+    decode(elf, data, sys.stdout, opts.timestamps)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""Local stand-in for the OpenWeatherMap, Open-Meteo, Google Geolocation
+and ip-api endpoints the firmware calls, with latency and fault injection.
+
+Serves the recorded responses in tools/mock_responses/ so fetch paths and
+timeouts can be benchmarked without spending API quota. Point the firmware
+at it with build flags (see README, "Testing Against a Local Mock API"):
+
+    python3 tools/mock_api_server.py --port 8080 --latency 300 --bandwidth 4000
+
+Faults apply to every request, or only to paths matching --only:
+
+    --latency MS        delay before the status line (time to first byte)
+    --jitter MS         extra random delay, 0..MS
+    --bandwidth BPS     cap on bytes per second for headers and body
+    --drip BYTES:MS     slow drip: send BYTES, then pause MS, until done
+    --truncate FRACTION send only this share of the body, then close
+    --error CODE        answer with this status instead (429 adds Retry-After)
+    --error-rate P      probability of --error per request (default 1.0)
+    --chunked           chunked transfer encoding instead of Content-Length
+    --close             no keep-alive: close after every response
+    --identity          ignore Accept-Encoding: gzip and send bodies uncompressed
+"""
+
+import argparse
+import gzip
+import os
+import random
+import re
+import socket
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import urlsplit
+
+RESPONSES_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "mock_responses")
+
+# (method, path) -> (recorded file, content type)
+ROUTES = {
+    ("GET", "/data/2.5/weather"): ("weather.json", "application/json; charset=utf-8"),
+    ("GET", "/data/2.5/forecast"): ("forecast.json", "application/json; charset=utf-8"),
+    ("GET", "/v1/forecast"): ("open_meteo.json", "application/json; charset=utf-8"),
+    ("POST", "/geolocation/v1/geolocate"): ("geolocate.json", "application/json; charset=UTF-8"),
+    ("GET", "/line/"): ("timezone.txt", "text/plain; charset=utf-8"),
+}
+
+ERROR_BODIES = {
+    429: b'{"cod":429,"message":"Your account is temporary blocked due to exceeding of requests limitation of your subscription type."}',
+    500: b'{"cod":500,"message":"Internal error"}',
+    502: b'{"cod":502,"message":"Bad gateway"}',
+    503: b'{"cod":503,"message":"Service unavailable"}',
+}
+
+REASONS = {200: "OK", 404: "Not Found", 405: "Method Not Allowed", 429: "Too Many Requests",
+           500: "Internal Server Error", 502: "Bad Gateway", 503: "Service Unavailable"}
+
+log_lock = threading.Lock()
+
+
+def redact(path):
+    """Keep API keys out of the log."""
+    return re.sub(r"(appid|key)=[^&]*", r"\1=...", path)
+
+
+class Throttle:
+    """Writes to a socket no faster than the configured rate and drip."""
+
+    def __init__(self, wfile, bandwidth, drip):
+        self.wfile = wfile
+        self.bandwidth = bandwidth
+        self.drip = drip
+        self.sent = 0
+        self.start = time.monotonic()
+
+    def write(self, data):
+        step = len(data)
+        if self.drip:
+            step = self.drip[0]
+        elif self.bandwidth:
+            step = max(1, self.bandwidth // 20)  # ~50 ms slices
+        for i in range(0, len(data), step):
+            piece = data[i:i + step]
+            self.wfile.write(piece)
+            self.wfile.flush()
+            self.sent += len(piece)
+            if self.drip and i + step < len(data):
+                time.sleep(self.drip[1] / 1000.0)
+            if self.bandwidth:
+                ahead = self.sent / self.bandwidth - (time.monotonic() - self.start)
+                if ahead > 0:
+                    time.sleep(ahead)
+
+
+class MockHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "MockWeatherAPI/1.0"
+    options = None  # argparse namespace, set in main()
+
+    def log_message(self, fmt, *args):
+        pass  # One line per request is printed by respond()
+
+    def do_GET(self):
+        self.handle_request("GET")
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length") or 0)
+        if length:
+            self.rfile.read(length)
+        self.handle_request("POST")
+
+    def handle_request(self, method):
+        opts = self.options
+        started = time.monotonic()
+        path = urlsplit(self.path).path
+        faulty = opts.only is None or re.search(opts.only, path) is not None
+
+        route = ROUTES.get((method, path))
+        if route is None:
+            status = 405 if any(p == path for _, p in ROUTES) else 404
+            body, ctype = b'{"cod":"404","message":"not found"}', "application/json"
+        elif faulty and opts.error and random.random() < opts.error_rate:
+            status = opts.error
+            body = ERROR_BODIES.get(status, b'{"message":"injected error"}')
+            ctype = "application/json"
+        else:
+            status = 200
+            with open(os.path.join(opts.responses, route[0]), "rb") as f:
+                body = f.read()
+            ctype = route[1]
+
+        # Compress like the real API does when asked; truncation and
+        # throttling then apply to the compressed bytes, as on the air
+        encoding = None
+        if (status == 200 and not opts.identity and
+                "gzip" in (self.headers.get("Accept-Encoding") or "")):
+            body = gzip.compress(body, mtime=0)
+            encoding = "gzip"
+
+        if faulty:
+            delay = opts.latency + (random.uniform(0, opts.jitter) if opts.jitter else 0)
+            if delay:
+                time.sleep(delay / 1000.0)
+
+        chunked = faulty and opts.chunked
+        truncate = faulty and opts.truncate is not None and status == 200
+        close = opts.close or truncate
+
+        headers = ["HTTP/1.1 %d %s" % (status, REASONS.get(status, "Error")),
+                   "Content-Type: " + ctype]
+        if encoding:
+            headers.append("Content-Encoding: " + encoding)
+        if chunked:
+            headers.append("Transfer-Encoding: chunked")
+        else:
+            headers.append("Content-Length: %d" % len(body))
+        if status == 429:
+            headers.append("Retry-After: 60")
+        headers.append("Connection: " + ("close" if close else "keep-alive"))
+        head = ("\r\n".join(headers) + "\r\n\r\n").encode("ascii")
+
+        out = Throttle(self.wfile, opts.bandwidth if faulty else 0,
+                       opts.drip if faulty else None)
+        payload = body[:int(len(body) * opts.truncate)] if truncate else body
+        try:
+            out.write(head)
+            if chunked:
+                # Chunk sizes that don't line up with the firmware's buffers
+                for i in range(0, len(payload), 1000):
+                    piece = payload[i:i + 1000]
+                    out.write(b"%x\r\n" % len(piece) + piece + b"\r\n")
+                if not truncate:
+                    out.write(b"0\r\n\r\n")
+            else:
+                out.write(payload)
+        except (BrokenPipeError, ConnectionResetError):
+            close = True
+
+        self.close_connection = close
+        if truncate:
+            try:
+                self.connection.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+
+        with log_lock:
+            print("%-4s %-60s %d %6d/%d B %6.0f ms%s" % (
+                method, redact(self.path)[:60], status, out.sent - len(head), len(body),
+                (time.monotonic() - started) * 1000,
+                (" gzip" if encoding else "") + (" (truncated)" if truncate else "")),
+                flush=True)
+
+
+def parse_drip(value):
+    size, _, pause = value.partition(":")
+    return int(size), int(pause or 0)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--bind", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--responses", default=RESPONSES_DIR, help="recorded responses directory")
+    parser.add_argument("--latency", type=float, default=0, help="ms before the status line")
+    parser.add_argument("--jitter", type=float, default=0, help="random extra ms, 0..N")
+    parser.add_argument("--bandwidth", type=int, default=0, help="bytes per second, 0 = unlimited")
+    parser.add_argument("--drip", type=parse_drip, default=None, help="BYTES:MS slow drip")
+    parser.add_argument("--truncate", type=float, default=None, help="share of body to send, 0-1")
+    parser.add_argument("--error", type=int, default=None, help="status code to inject")
+    parser.add_argument("--error-rate", type=float, default=1.0, help="probability of --error")
+    parser.add_argument("--chunked", action="store_true")
+    parser.add_argument("--close", action="store_true", help="disable keep-alive")
+    parser.add_argument("--identity", action="store_true", help="never gzip responses")
+    parser.add_argument("--only", default=None, help="regex: inject faults only on these paths")
+    parser.add_argument("--seed", type=int, default=None)
+    opts = parser.parse_args()
+
+    random.seed(opts.seed)
+    MockHandler.options = opts
+    server = ThreadingHTTPServer((opts.bind, opts.port), MockHandler)
+    server.daemon_threads = True
+    print("Mock API on %s:%d, responses from %s" % (opts.bind, opts.port, opts.responses),
+          flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()